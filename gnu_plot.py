@@ -58,6 +58,13 @@ def main():
                 # [5]chunk_size_bytes
                 # [6]io_participation
                 # [7]filter
+                # [8]min_seconds .. [15]slowest_rank (cross-rank reduction)
+                # [16]timer_path [17]count [18]total_seconds
+                # [19]logical_bytes [20]stored_bytes [21]compression_ratio
+                # [22]effective_GBps [23]physical_GBps
+                # [24]zfp_mode [25]zfp_param [26]sweep_point
+                # [27]file_driver [28]backend_props [29]backend_stats
+                # [30]region_partition [31]server_timers
                 if chunks_per_rank == -1:
                     chunks_per_rank = parts[1]
 
@@ -65,9 +72,22 @@ def main():
                 workload_name = parts[0]
                 num_ranks = int(parts[2])
                 timer_tag = parts[3]
-                elapsed_seconds = float(parts[4])
+                # Prefer the slowest rank (job makespan) when it was recorded
+                elapsed_seconds = float(parts[10]) if len(parts) > 10 else float(parts[4])
                 io_participation = parts[6]
                 filter_key = parts[7]
+                # Each chunk size and chunks_per_rank of a sweep gets its own
+                # chart, otherwise their points land on one line per rank count
+                filter_key = f'{filter_key}_{parts[5]}B_{parts[1]}cpr'
+                # Each zfp mode of a sweep gets its own chart
+                if len(parts) > 25 and parts[24] not in ('none', 'reversible'):
+                    filter_key = f'{filter_key}_{parts[24]}_{parts[25]}'
+                # Shared-file and subfiled runs are charted separately
+                if len(parts) > 27 and parts[27] not in ('none', 'mpio'):
+                    filter_key = f'{filter_key}_{parts[27]}'
+                # So are the PDC region partition strategies
+                if len(parts) > 30 and parts[30] not in ('none', 'region_local'):
+                    filter_key = f'{filter_key}_{parts[30]}'
 
                 # Store data point into nested dictionary structure
                 dict_csv[timer_tag][filter_key][workload_name][io_participation].append((num_ranks, elapsed_seconds))
@@ -10,6 +10,8 @@ echo "Using $LAUNCHER with $TOTAL_NODES total nodes"
 cd ./build
 
 PDC_DATA_PATH=/pscratch/sd/n/nlewi26/pdc_data
+# Servers write here and the benchmark measures it for stored_bytes
+export PDC_DATA_LOC=$PDC_DATA_PATH
 
 # Remove last workloads files
 # Need to be in build dir to work
@@ -19,7 +21,7 @@ function clean_old_files() {
 
 function clean_between_workload_files() {
 	rm -rf "${PDC_DATA_PATH:?}"/*
-	rm -f output.h5
+	rm -f output.h5 output.h5.*
 }
 
 # 1 Argument the path to the workload to runf
@@ -54,12 +56,15 @@ function run_benchmark() {
 
 			echo "CLIENT_CLOSE_LOG=$CLIENT_CLOSE_LOG, CLIENT_CLOSE_LOG_ERR=$CLIENT_CLOSE_LOG_ERR"
 			echo "SERVER_LOG=$SERVER_LOG, SERVER_LOG_ERR=$SERVER_LOG_ERR"
+			# The benchmark reads the server timers from here, stdbuf keeps it line
+			# buffered so each workload sees its own timer lines
+			export PDC_SERVER_LOG=$SERVER_LOG
 			echo "Starting PDC servers"
 			srun --nodes=$NUM_NODES \
 				--ntasks-per-node=1 \
 				--error="$SERVER_LOG_ERR" \
 				--output="$SERVER_LOG" \
-				pdc_server &
+				stdbuf -oL pdc_server &
 			echo "Sleeping after server start"
 			sleep 1
 		fi
@@ -78,18 +83,44 @@ function run_benchmark() {
 				--error="$CLIENT_CLOSE_LOG_ERR"\
 				--output="$CLIENT_CLOSE_LOG" \
 				close_server
-			# Shows PDC data size
-			find /pscratch/sd/n/nlewi26/pdc_data -type f | wc -l
-			find /pscratch/sd/n/nlewi26/pdc_data -type f -exec stat --printf="%s %n\n" {} \;
-		else 
-			# Shows HDF5 data size
-			/pscratch/sd/n/nlewi26/src/hdf5/install/bin/h5ls -v output.h5
 		fi
 	done
 
 	clean_between_workload_files
 }
 
+# Runs a config that sweeps "num_ranks" itself, one launch covers every point
+# 1 Argument the path to the workload to run
+# 2 Argument is just name of workloads for logging
+# 3 Argument is true or false indicating whether PDC servers should be launched/closed
+function run_sweep() {
+	if [ "$3" = "true" ]; then
+		rm -rf "${PDC_DATA_PATH:?}"/*
+		export PDC_SERVER_LOG=server_sweep_$2.log
+		srun --nodes=$TOTAL_NODES \
+			--ntasks-per-node=1 \
+			--error="server_sweep_$2.err" \
+			--output="server_sweep_$2.log" \
+			stdbuf -oL pdc_server &
+		sleep 1
+	fi
+
+	srun --ntasks=$TOTAL_TASKS \
+		--output="client_sweep_$2.log" \
+		--error="client_sweep_$2.err" \
+		./zfp_baseline $1
+
+	if [ "$3" = "true" ]; then
+		srun --nodes=$TOTAL_NODES \
+			--ntasks-per-node=1 \
+			--error="client_close_sweep_$2.err" \
+			--output="client_close_sweep_$2.log" \
+			close_server
+	fi
+
+	clean_between_workload_files
+}
+
 clean_old_files
 run_benchmark "/pscratch/sd/n/nlewi26/src/hdf5-zfp-baseline/workloads/pdc_raw.json" "pdc_raw" true
 run_benchmark "/pscratch/sd/n/nlewi26/src/hdf5-zfp-baseline/workloads/pdc_zfp.json" "pdc_zfp" true
@@ -1,6 +1,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
+#include <math.h>
 #include <mpi.h>
 
 #include "common.h"
@@ -8,20 +10,222 @@
 
 char *io_filter_strings[] = {"raw", "zfp_compress", "zfp_compress_transform"};
 const char *io_participation_strings[] = {"collective", "independent"};
-char *io_impl_strings[] = {"hdf5", "hdf5_zfp", "pdc", "pdc_zfp"};
-const char *timer_tags[] = {"write_chunk", "write_all_chunks",
-                            "read_chunk",  "read_all_chunks",
-                            "write_flush", "read_flush"};
+char *io_impl_strings[] = {"hdf5", "hdf5_zfp", "pdc", "pdc_zfp",
+                            "hdf5_direct", "hdf5_async"};
+#define OUTPUT_FILENAME "output.csv"
+#define SAMPLES_FILENAME "timer_samples.csv"
+#define BYTES_PER_GB (1024.0 * 1024 * 1024)
 
-double timer_start_times[TIMER_TAGS_COUNT];
-double timer_accumulated[TIMER_TAGS_COUNT] = {0};
+typedef struct timer_stats_t {
+    double min;
+    double mean;
+    double max;
+    double stddev;
+    double p50;
+    double p95;
+    double p99;
+    int slowest_rank;
+} timer_stats_t;
 
-#define OUTPUT_FILENAME "output.csv"
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+// linear interpolation between the closest ranks of an ascending array
+static double percentile(const double *sorted, int n, double p) {
+    double pos = p * (n - 1);
+    int lo = (int) pos;
+    if (lo >= n - 1) return sorted[n - 1];
+    return sorted[lo] + (pos - lo) * (sorted[lo + 1] - sorted[lo]);
+}
+
+static timer_stats_t reduce_timer(const double *values, int n,
+                                  double *scratch) {
+    timer_stats_t stats = {values[0], 0.0, values[0], 0.0, 0.0, 0.0, 0.0, 0};
+
+    double sum = 0.0;
+    for (int r = 0; r < n; r++) {
+        sum += values[r];
+        if (values[r] < stats.min) stats.min = values[r];
+        if (values[r] > stats.max) {
+            stats.max = values[r];
+            stats.slowest_rank = r;
+        }
+    }
+    stats.mean = sum / n;
+
+    double sum_sq = 0.0;
+    for (int r = 0; r < n; r++)
+        sum_sq += (values[r] - stats.mean) * (values[r] - stats.mean);
+    stats.stddev = sqrt(sum_sq / n);
+
+    memcpy(scratch, values, n * sizeof(double));
+    qsort(scratch, n, sizeof(double), compare_doubles);
+    stats.p50 = percentile(scratch, n, 0.50);
+    stats.p95 = percentile(scratch, n, 0.95);
+    stats.p99 = percentile(scratch, n, 0.99);
+
+    return stats;
+}
+
+/**
+ * Builds the list of timer paths that ran on any rank, in rank 0's order
+ * followed by paths only other ranks used. Ranks normally run the same
+ * timers so only the rare extra paths are gathered. Returns the number of
+ * paths, *paths holds MAX_TIMER_PATH_SIZE byte records.
+ */
+static int union_timer_paths(MPI_Comm comm, char **paths) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+
+    int num_local = 0;
+    char *local = malloc(timers_count() * MAX_TIMER_PATH_SIZE + 1);
+    for (uint32_t i = 0; i < timers_count(); i++) {
+        if (timer_get(i)->count == 0) continue;
+        timer_path(i, &local[num_local * MAX_TIMER_PATH_SIZE],
+                   MAX_TIMER_PATH_SIZE);
+        num_local++;
+    }
+
+    int num_union = num_local;
+    MPI_Bcast(&num_union, 1, MPI_INT, 0, comm);
+    char *result = malloc(num_union * MAX_TIMER_PATH_SIZE + 1);
+    if (rank == 0) memcpy(result, local, num_union * MAX_TIMER_PATH_SIZE);
+    MPI_Bcast(result, num_union * MAX_TIMER_PATH_SIZE, MPI_CHAR, 0, comm);
+
+    // paths rank 0 does not know about
+    int num_extra = 0;
+    char *extra = malloc(num_local * MAX_TIMER_PATH_SIZE + 1);
+    for (int i = 0; i < num_local; i++) {
+        char *path = &local[i * MAX_TIMER_PATH_SIZE];
+        bool found = false;
+        for (int j = 0; j < num_union && !found; j++)
+            found = !strcmp(path, &result[j * MAX_TIMER_PATH_SIZE]);
+        if (!found)
+            memcpy(&extra[(num_extra++) * MAX_TIMER_PATH_SIZE], path,
+                   MAX_TIMER_PATH_SIZE);
+    }
+
+    int num_ranks;
+    MPI_Comm_size(comm, &num_ranks);
+    int *extra_bytes = NULL, *displs = NULL;
+    char *all_extra = NULL;
+    int extra_size = num_extra * MAX_TIMER_PATH_SIZE, total_extra = 0;
+    if (rank == 0) {
+        extra_bytes = malloc(num_ranks * sizeof(int));
+        displs = malloc(num_ranks * sizeof(int));
+    }
+    MPI_Gather(&extra_size, 1, MPI_INT, extra_bytes, 1, MPI_INT, 0, comm);
+    if (rank == 0) {
+        for (int r = 0; r < num_ranks; r++) {
+            displs[r] = total_extra;
+            total_extra += extra_bytes[r];
+        }
+        all_extra = malloc(total_extra + 1);
+    }
+    MPI_Gatherv(extra, extra_size, MPI_CHAR, all_extra, extra_bytes, displs,
+                MPI_CHAR, 0, comm);
 
+    if (rank == 0) {
+        for (int e = 0; e < total_extra / MAX_TIMER_PATH_SIZE; e++) {
+            char *path = &all_extra[e * MAX_TIMER_PATH_SIZE];
+            bool found = false;
+            for (int j = 0; j < num_union && !found; j++)
+                found = !strcmp(path, &result[j * MAX_TIMER_PATH_SIZE]);
+            if (found) continue;
+            result = realloc(result, (num_union + 1) * MAX_TIMER_PATH_SIZE);
+            memcpy(&result[(num_union++) * MAX_TIMER_PATH_SIZE], path,
+                   MAX_TIMER_PATH_SIZE);
+        }
+    }
+    MPI_Bcast(&num_union, 1, MPI_INT, 0, comm);
+    if (rank != 0)
+        result = realloc(result, num_union * MAX_TIMER_PATH_SIZE + 1);
+    MPI_Bcast(result, num_union * MAX_TIMER_PATH_SIZE, MPI_CHAR, 0, comm);
+
+    free(local);
+    free(extra);
+    free(extra_bytes);
+    free(displs);
+    free(all_extra);
+    *paths = result;
+    return num_union;
+}
+
+static int find_timer_by_path(const char *path) {
+    char cur[MAX_TIMER_PATH_SIZE];
+    for (uint32_t i = 0; i < timers_count(); i++) {
+        if (timer_get(i)->count == 0) continue;
+        timer_path(i, cur, MAX_TIMER_PATH_SIZE);
+        if (!strcmp(cur, path)) return i;
+    }
+    return -1;
+}
+
+// rank 0's individual samples in long format, one row per sample
+static void print_timer_samples_csv(config_t *config,
+                                    config_workload_t *config_workload) {
+    FILE *fp_check = fopen(SAMPLES_FILENAME, "r");
+    int file_exists = (fp_check != NULL);
+    if (fp_check) fclose(fp_check);
+
+    FILE *fp = fopen(SAMPLES_FILENAME, "a");
+    if (!fp) {
+        PRINT_ERROR("Could not open file %s for appending\n",
+                    SAMPLES_FILENAME);
+        return;
+    }
+    if (!file_exists)
+        fprintf(fp, "[0]workload_name,[1]num_ranks,[2]io_participation,[3]"
+                    "timer_path,[4]sample,[5]seconds,[6]zfp_mode,[7]zfp_"
+                    "param,[8]sweep_point\n");
+
+    char path[MAX_TIMER_PATH_SIZE];
+    for (uint32_t i = 0; i < timers_count(); i++) {
+        const timer_entry_t *timer = timer_get(i);
+        timer_path(i, path, MAX_TIMER_PATH_SIZE);
+        for (uint64_t j = 0; j < timer->count; j++)
+            fprintf(fp, "%s,%d,%s,%s,%lu,%f,%s,%g,%u\n",
+                    config_workload->name, config->num_ranks,
+                    config->io_participation, path, j, timer->samples[j],
+                    config->zfp.mode, config->zfp.param, config->sweep_point);
+    }
+    fclose(fp);
+}
+
+/**
+ * Every rank reports the mean sample of each timer, rank 0 reduces them into
+ * min/mean/max/stddev/percentiles so the slowest rank, which defines the
+ * job's I/O time, shows up in the results. elapsed_seconds, count and
+ * total_seconds are rank 0's own values.
+ *
+ * Bandwidth is the same on every row of a workload: logical (effective) or
+ * stored (physical) bytes over the slowest rank's write_all_chunks or
+ * read_all_chunks time.
+ */
 void print_all_timers_csv(config_t *config,
                           config_workload_t *config_workload) {
-    int rank;
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm comm = config->comm;
+    int rank, num_ranks;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &num_ranks);
+
+    char *paths;
+    int num_paths = union_timer_paths(config->comm, &paths);
+
+    double *local = malloc((num_paths + 1) * sizeof(double));
+    for (int i = 0; i < num_paths; i++) {
+        int id = find_timer_by_path(&paths[i * MAX_TIMER_PATH_SIZE]);
+        local[i] = id < 0 ? 0.0 : timer_get(id)->total / timer_get(id)->count;
+    }
+
+    // all[r * num_paths + i] is timer i on rank r
+    double *all = NULL;
+    if (rank == 0)
+        all = (double *) malloc((num_ranks * num_paths + 1) * sizeof(double));
+    MPI_Gather(local, num_paths, MPI_DOUBLE, all, num_paths, MPI_DOUBLE, 0,
+               comm);
 
     if (rank == 0) {
         // Check if file exists
@@ -34,6 +238,9 @@ void print_all_timers_csv(config_t *config,
         if (!fp) {
             PRINT_ERROR("Could not open file %s for appending\n",
                         OUTPUT_FILENAME);
+            free(all);
+            free(local);
+            free(paths);
             return;
         }
 
@@ -43,23 +250,79 @@ void print_all_timers_csv(config_t *config,
                 fp,
                 "[0]workload_name,[1]chunks_per_rank,[2]num_ranks,[3]timer_tag,"
                 "[4]elapsed_seconds,[5]chunk_size_bytes,[6]io_participation,[7]"
-                "filter\n");
+                "filter,[8]min_seconds,[9]mean_seconds,[10]max_seconds,[11]"
+                "stddev_seconds,[12]p50_seconds,[13]p95_seconds,[14]p99_"
+                "seconds,[15]slowest_rank,[16]timer_path,[17]count,[18]total_"
+                "seconds,[19]logical_bytes,[20]stored_bytes,[21]compression_"
+                "ratio,[22]effective_GBps,[23]physical_GBps,[24]zfp_mode,[25]"
+                "zfp_param,[26]sweep_point,[27]file_driver,[28]backend_props,"
+                "[29]backend_stats,[30]region_partition,[31]server_timers\n");
         }
 
-        for (int i = 0; i < TIMER_TAGS_COUNT; i++) {
-            double time;
-            if (i == WRITE_ALL_CHUNKS || i == READ_ALL_CHUNKS)
-                time = timer_accumulated[i];
-            else
-                time = timer_accumulated[i] / config->chunks_per_rank;
-
-            fprintf(fp, "%s,%lu,%d,%s,%f,%lu,%s,%s\n", config_workload->name,
-                    config->chunks_per_rank, config->num_ranks, timer_tags[i],
-                    time, config->chunk_size_bytes, config->io_participation,
-                    config_workload->io_filter);
+        char backend_props[MAX_CONFIG_STRING_SIZE];
+        config_backend_props_string(config_workload, backend_props,
+                                    sizeof(backend_props));
+
+        double *values = (double *) malloc(num_ranks * sizeof(double));
+        double *scratch = (double *) malloc(num_ranks * sizeof(double));
+
+        char io_path[MAX_TIMER_PATH_SIZE];
+        snprintf(io_path, sizeof(io_path), "%s_all_chunks",
+                 config_workload->io_type);
+        double io_seconds = 0.0;
+        for (int i = 0; i < num_paths; i++) {
+            if (strcmp(&paths[i * MAX_TIMER_PATH_SIZE], io_path)) continue;
+            for (int r = 0; r < num_ranks; r++)
+                if (all[r * num_paths + i] > io_seconds)
+                    io_seconds = all[r * num_paths + i];
         }
+        double ratio = config->stored_bytes
+                           ? (double) config->total_bytes / config->stored_bytes
+                           : 0.0;
+        double effective_GBps =
+            io_seconds > 0 ? config->total_bytes / BYTES_PER_GB / io_seconds
+                           : 0.0;
+        double physical_GBps =
+            io_seconds > 0 ? config->stored_bytes / BYTES_PER_GB / io_seconds
+                           : 0.0;
+        for (int i = 0; i < num_paths; i++) {
+            const char *path = &paths[i * MAX_TIMER_PATH_SIZE];
+            const char *leaf = strrchr(path, '/');
+            leaf = leaf ? leaf + 1 : path;
+            int id = find_timer_by_path(path);
+
+            for (int r = 0; r < num_ranks; r++)
+                values[r] = all[r * num_paths + i];
+            timer_stats_t stats = reduce_timer(values, num_ranks, scratch);
+
+            fprintf(fp,
+                    "%s,%lu,%d,%s,%f,%lu,%s,%s,%f,%f,%f,%f,%f,%f,%f,%d,%s,%lu,"
+                    "%f,%lu,%lu,%f,%f,%f,%s,%g,%u,%s,%s,%s,%s,%s\n",
+                    config_workload->name, config->chunks_per_rank,
+                    config->num_ranks, leaf, local[i],
+                    config->chunk_size_bytes, config->io_participation,
+                    config_workload->io_filter, stats.min, stats.mean,
+                    stats.max, stats.stddev, stats.p50, stats.p95, stats.p99,
+                    stats.slowest_rank, path,
+                    id < 0 ? 0 : timer_get(id)->count,
+                    id < 0 ? 0.0 : timer_get(id)->total, config->total_bytes,
+                    config->stored_bytes, ratio, effective_GBps,
+                    physical_GBps, config->zfp.mode, config->zfp.param,
+                    config->sweep_point, config_file_driver(config_workload),
+                    backend_props,
+                    config->backend_stats[0] ? config->backend_stats : "none",
+                    config_region_partition(config_workload),
+                    config->server_timers[0] ? config->server_timers : "none");
+        }
+        free(values);
+        free(scratch);
 
         fclose(fp);
+        free(all);
+        print_timer_samples_csv(config, config_workload);
         PRINT_RANK0("Timer results appended to %s\n", OUTPUT_FILENAME);
     }
-}
\ No newline at end of file
+
+    free(local);
+    free(paths);
+}
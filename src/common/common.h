@@ -5,6 +5,7 @@
 #include <mpi.h>
 
 #include "config.h"
+#include "timer.h"
 
 extern char *io_impl_strings[];
 typedef enum io_impl_t {
@@ -12,6 +13,8 @@ typedef enum io_impl_t {
     HDF5_ZFP_IMPL,
     PDC_IMPL,
     PDC_ZFP_IMPL,
+    HDF5_DIRECT_IMPL,
+    HDF5_ASYNC_IMPL,
     NUM_IO_IMPL
 } io_impl_t;
 
@@ -92,6 +95,69 @@ typedef struct io_impl_funcs_t {
      * durable storage.
      */
     void (*flush)(config_t *config, config_workload_t *config_workload);
+    /**
+     * Starts writing a chunk of data without waiting for it to finish.
+     * Used by the pipelined driver, which keeps up to pipeline_depth chunks
+     * in flight. The buffer must not be touched by the caller until the chunk
+     * has been retired by complete_chunk.
+     */
+    void (*submit_write_chunk)(config_t *config,
+                               config_workload_t *config_workload,
+                               double *buffer);
+    /**
+     * Starts reading a chunk of data without waiting for it to finish.
+     * The buffer is only valid once the chunk has been retired by
+     * complete_chunk.
+     */
+    void (*submit_read_chunk)(config_t *config,
+                              config_workload_t *config_workload,
+                              double *buffer);
+    /**
+     * Waits for the oldest submitted chunk to finish and releases any
+     * resources the backend holds for it. Chunks complete in submission order.
+     */
+    void (*complete_chunk)(config_t *config,
+                           config_workload_t *config_workload);
+    /**
+     * Writes all of this rank's chunks in one call. Used by the batched
+     * driver so the backend can coalesce them into a single request.
+     *
+     * Parameters:
+     *  - buffer: chunks_per_rank chunks back to back, chunk 0 first
+     */
+    void (*write_chunks)(config_t *config, config_workload_t *config_workload,
+                         double *buffer);
+    /**
+     * Reads all of this rank's chunks in one call into buffer, laid out as
+     * for write_chunks.
+     */
+    void (*read_chunks)(config_t *config, config_workload_t *config_workload,
+                        double *buffer);
+    /**
+     * Persists the checksum of each of this rank's chunks next to the
+     * dataset. Called collectively after the write flush.
+     *
+     * Parameters:
+     *  - checksums: chunks_per_rank checksums of this rank's chunks
+     */
+    void (*store_checksums)(config_t *config,
+                            config_workload_t *config_workload,
+                            uint64_t *checksums);
+    /**
+     * Loads the checksums stored by store_checksums for this rank's chunks.
+     * Called collectively after the read flush.
+     */
+    void (*load_checksums)(config_t *config,
+                           config_workload_t *config_workload,
+                           uint64_t *checksums);
+    /**
+     * Returns the number of bytes the whole dataset occupies on storage after
+     * any filter has been applied, or 0 if the backend cannot tell. Called
+     * collectively once the data has been flushed, every rank must return the
+     * same value.
+     */
+    uint64_t (*get_storage_size)(config_t *config,
+                                 config_workload_t *config_workload);
     /**
      * Closes the dataset and file handles.
      * Release all resources associated with the dataset and file, ensuring a
@@ -100,33 +166,6 @@ typedef struct io_impl_funcs_t {
     void (*close_dataset)(config_t *config, config_workload_t *config_workload);
 } io_impl_funcs_t;
 
-typedef enum timer_tags_t {
-    WRITE_CHUNK,
-    WRITE_ALL_CHUNKS,
-    READ_CHUNK,
-    READ_ALL_CHUNKS,
-    WRITE_FLUSH,
-    READ_FLUSH,
-    TIMER_TAGS_COUNT
-} timer_tags_t;
-
-extern const char *timer_tags[];
-extern double timer_start_times[TIMER_TAGS_COUNT];
-extern double timer_accumulated[TIMER_TAGS_COUNT];
-
-// Start the timer for a tag
-#define START_TIMER(tag)                                                       \
-    do {                                                                       \
-        timer_start_times[(tag)] = MPI_Wtime();                                \
-    } while (0)
-
-// Stop the timer and accumulate elapsed time
-#define STOP_TIMER(tag)                                                        \
-    do {                                                                       \
-        double elapsed = MPI_Wtime() - timer_start_times[(tag)];               \
-        timer_accumulated[(tag)] += elapsed;                                   \
-    } while (0)
-
 void print_all_timers_csv(config_t *config, config_workload_t *config_workload);
 
 #endif
@@ -1,3 +1,8 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <libgen.h>
 #include <unistd.h>
 #include <assert.h>
 #include <fcntl.h>
@@ -9,6 +14,11 @@
 #include "log.h"
 #include "json-c/json.h"
 
+// the repo's tf_graphs directory, set by CMake
+#ifndef TF_GRAPHS_DIR
+#define TF_GRAPHS_DIR "tf_graphs/"
+#endif
+
 /**
  * Example configuration JSON:
  * {
@@ -21,17 +31,84 @@
  *                 "independent"
  *             ],
  *             "io_type": "read",
- *             "filter": "raw",
- *             "params": "none"
+ *             "filter": "raw",          (or a list to sweep over)
+ *             "params": "none",
+ *             "driver": "pipelined",     (optional, "sync" or "batched",
+ *                                         default "sync")
+ *             "pipeline_depth": 4,       (optional, default 2)
+ *             "iterations": 10,          (optional, default 1)
+ *             "generator": {             (optional, default "random")
+ *                 "type": "grf",
+ *                 "seed": 42,
+ *                 "amplitude": 1.0,
+ *                 "wavelength": 64.0,
+ *                 "spectral_slope": 3.0,
+ *                 "num_modes": 32,
+ *                 "region_size": 32,
+ *                 "snr_db": 20.0
+ *             },
+ *             "verify": "checksum",      (optional, default "full")
+ *             "zfp": [                   (optional, default reversible,
+ *                                         HDF5 implementations only)
+ *                 {"mode": "reversible"},
+ *                 {"mode": "rate", "rate": 8},
+ *                 {"mode": "precision", "precision": 32},
+ *                 {"mode": "accuracy", "accuracy": 1e-6}
+ *             ],
+ *             "hdf5": {                  (optional, HDF5 implementations)
+ *                 "file_driver": "subfiling", (or "core", default "mpio")
+ *                 "backing_store": true,      (core, optional, default false)
+ *                 "stripe_size": 33554432,    (subfiling, optional)
+ *                 "ioc_per_node": 1,          (subfiling, optional)
+ *                 "chunk_cache_bytes": 67108864, (all optional from here)
+ *                 "chunk_cache_slots": 12421,
+ *                 "chunk_cache_w0": 0.75,
+ *                 "mdc_initial_size": 16777216,
+ *                 "mdc_max_size": 33554432,
+ *                 "coll_metadata_ops": true,
+ *                 "coll_metadata_write": true,
+ *                 "mpi_info": {
+ *                     "romio_cb_write": "enable",
+ *                     "cb_nodes": 16,
+ *                     "striping_factor": 64,
+ *                     "striping_unit": 4194304
+ *                 },
+ *                 "alignment": 4194304,
+ *                 "alignment_threshold": 65536, (optional, default 1)
+ *                 "alloc_time": "incr",       (or "early", "late")
+ *                 "fill_time": "never",       (or "alloc", "ifset")
+ *                 "file_space_strategy": "page", (or "default")
+ *                 "page_size": 4194304,       (page strategy, optional)
+ *                 "page_buffer_size": 16777216 (core and page strategy)
+ *             },
+ *             "pdc": {                   (optional, PDC implementations)
+ *                 "max_inflight": 64,    (optional, default 0 for all chunks)
+ *                 "reuse_transfers": true, (optional, default false)
+ *                 "region_partition": ["region_local", "obj_static"]
+ *                                        (or one of "region_static",
+ *                                        "region_dynamic", default
+ *                                        "region_local", a list is swept)
+ *                 "tf_graph": "../tf_graphs/compression_encryption.json",
+ *                                        (optional, relative to this file,
+ *                                        default tf_graphs/compression.json)
+ *                 "tf_source_state": "decompressed", (optional, default)
+ *                 "tf_target_state": "encrypted" (optional, default
+ *                                        "compressed")
+ *             }
  *         }
  *     ]
- *     "chunk_size_bytes": 64000,
- *     "chunks_per_rank": 1,
+ *     "chunk_size_bytes": 64000,     (optional with "layout")
+ *     "chunks_per_rank": 1,          (either may be a list to sweep over)
+ *     "num_ranks": [1, 2, 4],        (optional, default all ranks, PDC
+ *                                     workloads need all ranks)
+ *     "layout": {                    (optional, default square 2D chunks)
+ *         "chunk_dims": [64, 64, 64],
+ *         "global_dims": [128, 128, 64], (optional)
+ *         "rank_grid": [2, 2, 1]         (optional)
+ *     }
  * }
  */
 
-#define CONFIG_ERROR_PREFIX "[CONFIG_ERROR] "
-
 static struct array_list *validate_json_array(struct json_object *json_obj,
                                               char *arr_name,
                                               uint32_t min_length,
@@ -87,6 +164,32 @@ static int validate_json_number(struct json_object *json_obj, char *num_name) {
     return json_object_get_int(num_json_obj);
 }
 
+static double validate_json_double(struct json_object *json_obj,
+                                   char *num_name) {
+    struct json_object *num_json_obj;
+
+    ASSERT(json_object_object_get_ex(json_obj, num_name, &num_json_obj),
+           CONFIG_ERROR_PREFIX "Failed to find %s in JSON config\n", num_name);
+    ASSERT(json_object_get_type(num_json_obj) == json_type_double ||
+               json_object_get_type(num_json_obj) == json_type_int,
+           CONFIG_ERROR_PREFIX "%s must be a number\n", num_name);
+
+    return json_object_get_double(num_json_obj);
+}
+
+static uint64_t validate_json_size(struct json_object *json_obj,
+                                   char *num_name) {
+    struct json_object *num_json_obj;
+
+    ASSERT(json_object_object_get_ex(json_obj, num_name, &num_json_obj),
+           CONFIG_ERROR_PREFIX "Failed to find %s in JSON config\n", num_name);
+    ASSERT(json_object_get_type(num_json_obj) == json_type_int &&
+               json_object_get_int64(num_json_obj) >= 0,
+           CONFIG_ERROR_PREFIX "%s must be a number >= 0\n", num_name);
+
+    return json_object_get_int64(num_json_obj);
+}
+
 static bool validate_json_bool(struct json_object *json_obj, char *bool_name) {
     struct json_object *bool_json_obj;
 
@@ -98,6 +201,609 @@ static bool validate_json_bool(struct json_object *json_obj, char *bool_name) {
     return json_object_get_boolean(bool_json_obj);
 }
 
+static bool json_has_key(struct json_object *json_obj, char *key) {
+    return json_object_object_get_ex(json_obj, key, NULL);
+}
+
+static void parse_datagen(struct json_object *workload,
+                          config_datagen_t *datagen) {
+    strcpy(datagen->type, "random");
+    datagen->seed = 42;
+    datagen->amplitude = 1.0;
+    datagen->wavelength = 64.0;
+    datagen->spectral_slope = 3.0;
+    datagen->num_modes = 32;
+    datagen->region_size = 32;
+    datagen->snr_db = 20.0;
+
+    struct json_object *gen;
+    if (!json_object_object_get_ex(workload, "generator", &gen)) return;
+    ASSERT(json_object_get_type(gen) == json_type_object,
+           CONFIG_ERROR_PREFIX "generator must be an object\n");
+
+    const char *type =
+        validate_json_string(gen, "type", MAX_CONFIG_STRING_SIZE);
+    ASSERT(!strcmp(type, "random") || !strcmp(type, "smooth") ||
+               !strcmp(type, "grf") || !strcmp(type, "piecewise") ||
+               !strcmp(type, "noise"),
+           CONFIG_ERROR_PREFIX "Invalid generator type %s\n", type);
+    strcpy(datagen->type, type);
+
+    if (json_has_key(gen, "seed"))
+        datagen->seed = validate_json_number(gen, "seed");
+    if (json_has_key(gen, "amplitude"))
+        datagen->amplitude = validate_json_double(gen, "amplitude");
+    if (json_has_key(gen, "wavelength"))
+        datagen->wavelength = validate_json_double(gen, "wavelength");
+    if (json_has_key(gen, "spectral_slope"))
+        datagen->spectral_slope = validate_json_double(gen, "spectral_slope");
+    if (json_has_key(gen, "num_modes"))
+        datagen->num_modes = validate_json_number(gen, "num_modes");
+    if (json_has_key(gen, "region_size"))
+        datagen->region_size = validate_json_number(gen, "region_size");
+    if (json_has_key(gen, "snr_db"))
+        datagen->snr_db = validate_json_double(gen, "snr_db");
+
+    ASSERT(datagen->wavelength > 0,
+           CONFIG_ERROR_PREFIX "wavelength must be > 0\n");
+    ASSERT(datagen->num_modes >= 1,
+           CONFIG_ERROR_PREFIX "num_modes must be >= 1\n");
+    ASSERT(datagen->region_size >= 1,
+           CONFIG_ERROR_PREFIX "region_size must be >= 1\n");
+}
+
+// MPI_Info values are strings, numbers are accepted for convenience
+static void parse_mpi_hints(struct json_object *hdf5_json,
+                            config_hdf5_t *hdf5) {
+    struct json_object *info;
+    if (!json_object_object_get_ex(hdf5_json, "mpi_info", &info)) return;
+    ASSERT(json_object_get_type(info) == json_type_object,
+           CONFIG_ERROR_PREFIX "mpi_info must be an object\n");
+
+    json_object_object_foreach(info, key, value) {
+        ASSERT(hdf5->num_mpi_hints < MAX_CONFIG_MPI_HINTS,
+               CONFIG_ERROR_PREFIX "mpi_info holds more than %d hints\n",
+               MAX_CONFIG_MPI_HINTS);
+        ASSERT(json_object_get_type(value) == json_type_string ||
+                   json_object_get_type(value) == json_type_int,
+               CONFIG_ERROR_PREFIX "mpi_info %s must be a string or number\n",
+               key);
+        const char *str = json_object_get_string(value);
+        ASSERT(strlen(key) < MAX_CONFIG_STRING_SIZE &&
+                   strlen(str) < MAX_CONFIG_STRING_SIZE,
+               CONFIG_ERROR_PREFIX "mpi_info %s is too long\n", key);
+
+        strcpy(hdf5->mpi_hints[hdf5->num_mpi_hints][0], key);
+        strcpy(hdf5->mpi_hints[hdf5->num_mpi_hints][1], str);
+        hdf5->num_mpi_hints++;
+    }
+}
+
+static void parse_hdf5(struct json_object *workload, config_hdf5_t *hdf5) {
+    memset(hdf5, 0, sizeof(*hdf5));
+    strcpy(hdf5->file_driver, "mpio");
+    hdf5->chunk_cache_w0 = -1.0;
+    strcpy(hdf5->alloc_time, "default");
+    strcpy(hdf5->fill_time, "default");
+    strcpy(hdf5->file_space_strategy, "default");
+
+    struct json_object *hdf5_json;
+    if (!json_object_object_get_ex(workload, "hdf5", &hdf5_json)) return;
+    ASSERT(json_object_get_type(hdf5_json) == json_type_object,
+           CONFIG_ERROR_PREFIX "hdf5 must be an object\n");
+
+    if (json_has_key(hdf5_json, "file_driver")) {
+        const char *driver = validate_json_string(hdf5_json, "file_driver",
+                                                  MAX_CONFIG_STRING_SIZE);
+        ASSERT(!strcmp(driver, "mpio") || !strcmp(driver, "subfiling") ||
+                   !strcmp(driver, "core"),
+               CONFIG_ERROR_PREFIX "Invalid file_driver %s\n", driver);
+        strcpy(hdf5->file_driver, driver);
+    }
+    if (json_has_key(hdf5_json, "backing_store"))
+        hdf5->backing_store = validate_json_bool(hdf5_json, "backing_store");
+    ASSERT(!strcmp(hdf5->file_driver, "core") || !hdf5->backing_store,
+           CONFIG_ERROR_PREFIX "backing_store needs the core file_driver\n");
+    if (json_has_key(hdf5_json, "stripe_size"))
+        hdf5->stripe_size = validate_json_size(hdf5_json, "stripe_size");
+    if (json_has_key(hdf5_json, "ioc_per_node"))
+        hdf5->ioc_per_node = validate_json_size(hdf5_json, "ioc_per_node");
+    ASSERT(!strcmp(hdf5->file_driver, "subfiling") ||
+               (!hdf5->stripe_size && !hdf5->ioc_per_node),
+           CONFIG_ERROR_PREFIX
+           "stripe_size and ioc_per_node need the subfiling file_driver\n");
+
+    if (json_has_key(hdf5_json, "chunk_cache_bytes"))
+        hdf5->chunk_cache_bytes =
+            validate_json_size(hdf5_json, "chunk_cache_bytes");
+    if (json_has_key(hdf5_json, "chunk_cache_slots"))
+        hdf5->chunk_cache_slots =
+            validate_json_size(hdf5_json, "chunk_cache_slots");
+    if (json_has_key(hdf5_json, "chunk_cache_w0")) {
+        hdf5->chunk_cache_w0 =
+            validate_json_double(hdf5_json, "chunk_cache_w0");
+        ASSERT(hdf5->chunk_cache_w0 >= 0.0 && hdf5->chunk_cache_w0 <= 1.0,
+               CONFIG_ERROR_PREFIX "chunk_cache_w0 must be 0 <= w0 <= 1\n");
+    }
+
+    if (json_has_key(hdf5_json, "mdc_initial_size"))
+        hdf5->mdc_initial_size =
+            validate_json_size(hdf5_json, "mdc_initial_size");
+    if (json_has_key(hdf5_json, "mdc_max_size"))
+        hdf5->mdc_max_size = validate_json_size(hdf5_json, "mdc_max_size");
+    ASSERT(!hdf5->mdc_initial_size || !hdf5->mdc_max_size ||
+               hdf5->mdc_initial_size <= hdf5->mdc_max_size,
+           CONFIG_ERROR_PREFIX "mdc_initial_size must be <= mdc_max_size\n");
+
+    if (json_has_key(hdf5_json, "coll_metadata_ops"))
+        hdf5->coll_metadata_ops =
+            validate_json_bool(hdf5_json, "coll_metadata_ops");
+    if (json_has_key(hdf5_json, "coll_metadata_write"))
+        hdf5->coll_metadata_write =
+            validate_json_bool(hdf5_json, "coll_metadata_write");
+
+    parse_mpi_hints(hdf5_json, hdf5);
+    if (json_has_key(hdf5_json, "alignment"))
+        hdf5->alignment = validate_json_size(hdf5_json, "alignment");
+    hdf5->alignment_threshold = 1;
+    if (json_has_key(hdf5_json, "alignment_threshold"))
+        hdf5->alignment_threshold =
+            validate_json_size(hdf5_json, "alignment_threshold");
+
+    if (json_has_key(hdf5_json, "alloc_time")) {
+        const char *alloc_time = validate_json_string(
+            hdf5_json, "alloc_time", MAX_CONFIG_STRING_SIZE);
+        ASSERT(!strcmp(alloc_time, "default") ||
+                   !strcmp(alloc_time, "early") ||
+                   !strcmp(alloc_time, "incr") || !strcmp(alloc_time, "late"),
+               CONFIG_ERROR_PREFIX "Invalid alloc_time %s\n", alloc_time);
+        strcpy(hdf5->alloc_time, alloc_time);
+    }
+    if (json_has_key(hdf5_json, "fill_time")) {
+        const char *fill_time = validate_json_string(hdf5_json, "fill_time",
+                                                     MAX_CONFIG_STRING_SIZE);
+        ASSERT(!strcmp(fill_time, "default") || !strcmp(fill_time, "alloc") ||
+                   !strcmp(fill_time, "ifset") || !strcmp(fill_time, "never"),
+               CONFIG_ERROR_PREFIX "Invalid fill_time %s\n", fill_time);
+        strcpy(hdf5->fill_time, fill_time);
+    }
+
+    if (json_has_key(hdf5_json, "file_space_strategy")) {
+        const char *strategy = validate_json_string(
+            hdf5_json, "file_space_strategy", MAX_CONFIG_STRING_SIZE);
+        ASSERT(!strcmp(strategy, "default") || !strcmp(strategy, "page"),
+               CONFIG_ERROR_PREFIX "Invalid file_space_strategy %s\n",
+               strategy);
+        strcpy(hdf5->file_space_strategy, strategy);
+    }
+    if (json_has_key(hdf5_json, "page_size"))
+        hdf5->page_size = validate_json_size(hdf5_json, "page_size");
+    ASSERT(!hdf5->page_size || !strcmp(hdf5->file_space_strategy, "page"),
+           CONFIG_ERROR_PREFIX
+           "page_size needs the page file_space_strategy\n");
+    if (json_has_key(hdf5_json, "page_buffer_size"))
+        hdf5->page_buffer_size =
+            validate_json_size(hdf5_json, "page_buffer_size");
+    // parallel HDF5 has no page buffer and HDF5 only pages paged files
+    ASSERT(!hdf5->page_buffer_size ||
+               (!strcmp(hdf5->file_driver, "core") &&
+                !strcmp(hdf5->file_space_strategy, "page")),
+           CONFIG_ERROR_PREFIX "page_buffer_size needs the core file_driver "
+                               "and the page file_space_strategy\n");
+}
+
+// a region partition name or a list of them to sweep over
+static void parse_region_partitions(struct json_object *pdc_json,
+                                    config_pdc_t *pdc) {
+    struct json_object *partition;
+    json_object_object_get_ex(pdc_json, "region_partition", &partition);
+
+    if (json_object_get_type(partition) == json_type_array) {
+        struct array_list *partitions =
+            validate_json_array(pdc_json, "region_partition", 1,
+                                MAX_CONFIG_REGION_PARTITIONS);
+        pdc->num_region_partitions = array_list_length(partitions);
+        for (uint32_t i = 0; i < pdc->num_region_partitions; i++)
+            strcpy(pdc->region_partitions[i],
+                   validate_json_string_raw(array_list_get_idx(partitions, i),
+                                            MAX_CONFIG_STRING_SIZE));
+    } else {
+        pdc->num_region_partitions = 1;
+        strcpy(pdc->region_partitions[0],
+               validate_json_string(pdc_json, "region_partition",
+                                    MAX_CONFIG_STRING_SIZE));
+    }
+
+    for (uint32_t i = 0; i < pdc->num_region_partitions; i++) {
+        const char *name = pdc->region_partitions[i];
+        ASSERT(!strcmp(name, "region_local") ||
+                   !strcmp(name, "region_static") ||
+                   !strcmp(name, "region_dynamic") ||
+                   !strcmp(name, "obj_static"),
+               CONFIG_ERROR_PREFIX "Invalid region_partition %s\n", name);
+    }
+}
+
+/**
+ * Makes a path from the config absolute, relative paths start at the
+ * directory of the config file. PDC servers open transform graphs
+ * themselves, so the path must not depend on the client's directory.
+ */
+static void resolve_config_path(const char *config_dir, const char *path,
+                                char *resolved) {
+    char joined[PATH_MAX], real[PATH_MAX];
+    if (path[0] == '/')
+        snprintf(joined, sizeof(joined), "%s", path);
+    else
+        snprintf(joined, sizeof(joined), "%s/%s", config_dir, path);
+
+    ASSERT(realpath(joined, real),
+           CONFIG_ERROR_PREFIX "Failed to find %s\n", joined);
+    ASSERT(strlen(real) < MAX_CONFIG_STRING_SIZE,
+           CONFIG_ERROR_PREFIX "Path %s is too long\n", real);
+    strcpy(resolved, real);
+}
+
+static void parse_pdc(struct json_object *workload, const char *config_dir,
+                      config_pdc_t *pdc) {
+    memset(pdc, 0, sizeof(*pdc));
+    pdc->num_region_partitions = 1;
+    strcpy(pdc->region_partitions[0], "region_local");
+    strcpy(pdc->region_partition, "region_local");
+    strcpy(pdc->tf_graph, TF_GRAPHS_DIR "compression.json");
+    strcpy(pdc->tf_source_state, "decompressed");
+    strcpy(pdc->tf_target_state, "compressed");
+
+    struct json_object *pdc_json;
+    if (!json_object_object_get_ex(workload, "pdc", &pdc_json)) return;
+    ASSERT(json_object_get_type(pdc_json) == json_type_object,
+           CONFIG_ERROR_PREFIX "pdc must be an object\n");
+
+    if (json_has_key(pdc_json, "max_inflight"))
+        pdc->max_inflight = validate_json_size(pdc_json, "max_inflight");
+    if (json_has_key(pdc_json, "reuse_transfers"))
+        pdc->reuse_transfers = validate_json_bool(pdc_json, "reuse_transfers");
+    if (json_has_key(pdc_json, "region_partition")) {
+        parse_region_partitions(pdc_json, pdc);
+        strcpy(pdc->region_partition, pdc->region_partitions[0]);
+    }
+
+    if (json_has_key(pdc_json, "tf_graph"))
+        resolve_config_path(config_dir,
+                            validate_json_string(pdc_json, "tf_graph",
+                                                 MAX_CONFIG_STRING_SIZE),
+                            pdc->tf_graph);
+    if (json_has_key(pdc_json, "tf_source_state"))
+        strcpy(pdc->tf_source_state,
+               validate_json_string(pdc_json, "tf_source_state",
+                                    MAX_CONFIG_STRING_SIZE));
+    if (json_has_key(pdc_json, "tf_target_state"))
+        strcpy(pdc->tf_target_state,
+               validate_json_string(pdc_json, "tf_target_state",
+                                    MAX_CONFIG_STRING_SIZE));
+}
+
+bool config_filter_is_zfp(config_workload_t *config_workload) {
+    return !strncmp(config_workload->io_filter, "zfp", 3);
+}
+
+bool config_zfp_is_lossy(config_t *config) {
+    return strcmp(config->zfp.mode, "none") &&
+           strcmp(config->zfp.mode, "reversible");
+}
+
+const char *config_file_driver(config_workload_t *config_workload) {
+    if (strncmp(config_workload->implementation, "hdf5", 4)) return "none";
+    return config_workload->hdf5.file_driver;
+}
+
+const char *config_region_partition(config_workload_t *config_workload) {
+    if (strncmp(config_workload->implementation, "pdc", 3)) return "none";
+    return config_workload->pdc.region_partition;
+}
+
+// appends one "key=value" pair to a ';' separated list
+static void append_prop(char *buf, size_t size, const char *fmt, ...) {
+    size_t len = strlen(buf);
+    if (len && len + 1 < size) buf[len++] = ';';
+    if (len >= size) return;
+
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(&buf[len], size - len, fmt, args);
+    va_end(args);
+}
+
+static void pdc_props_string(const config_pdc_t *pdc, char *buf,
+                             size_t size) {
+    if (pdc->max_inflight)
+        append_prop(buf, size, "max_inflight=%lu", pdc->max_inflight);
+    if (pdc->reuse_transfers) append_prop(buf, size, "reuse_transfers=1");
+    if (strcmp(pdc->tf_graph, TF_GRAPHS_DIR "compression.json")) {
+        // the file name is enough to tell graphs apart
+        const char *name = strrchr(pdc->tf_graph, '/');
+        append_prop(buf, size, "tf_graph=%s", name ? name + 1 : pdc->tf_graph);
+    }
+    if (strcmp(pdc->tf_source_state, "decompressed") ||
+        strcmp(pdc->tf_target_state, "compressed"))
+        append_prop(buf, size, "tf_states=%s>%s", pdc->tf_source_state,
+                    pdc->tf_target_state);
+}
+
+void config_backend_props_string(config_workload_t *config_workload,
+                                 char *buf, size_t size) {
+    const config_hdf5_t *hdf5 = &config_workload->hdf5;
+    buf[0] = '\0';
+    if (strncmp(config_workload->implementation, "hdf5", 4)) {
+        pdc_props_string(&config_workload->pdc, buf, size);
+        if (!buf[0]) snprintf(buf, size, "default");
+        return;
+    }
+
+    if (hdf5->stripe_size)
+        append_prop(buf, size, "stripe_size=%lu", hdf5->stripe_size);
+    if (hdf5->ioc_per_node)
+        append_prop(buf, size, "ioc_per_node=%u", hdf5->ioc_per_node);
+    if (hdf5->backing_store) append_prop(buf, size, "backing_store=1");
+    if (hdf5->chunk_cache_bytes)
+        append_prop(buf, size, "chunk_cache_bytes=%lu",
+                    hdf5->chunk_cache_bytes);
+    if (hdf5->chunk_cache_slots)
+        append_prop(buf, size, "chunk_cache_slots=%lu",
+                    hdf5->chunk_cache_slots);
+    if (hdf5->chunk_cache_w0 >= 0.0)
+        append_prop(buf, size, "chunk_cache_w0=%g", hdf5->chunk_cache_w0);
+    if (hdf5->mdc_initial_size)
+        append_prop(buf, size, "mdc_initial_size=%lu", hdf5->mdc_initial_size);
+    if (hdf5->mdc_max_size)
+        append_prop(buf, size, "mdc_max_size=%lu", hdf5->mdc_max_size);
+    if (hdf5->coll_metadata_ops) append_prop(buf, size, "coll_metadata_ops=1");
+    if (hdf5->coll_metadata_write)
+        append_prop(buf, size, "coll_metadata_write=1");
+    for (uint32_t i = 0; i < hdf5->num_mpi_hints; i++)
+        append_prop(buf, size, "mpi_info.%s=%s", hdf5->mpi_hints[i][0],
+                    hdf5->mpi_hints[i][1]);
+    if (hdf5->alignment)
+        append_prop(buf, size, "alignment=%lu/%lu", hdf5->alignment,
+                    hdf5->alignment_threshold);
+    if (strcmp(hdf5->alloc_time, "default"))
+        append_prop(buf, size, "alloc_time=%s", hdf5->alloc_time);
+    if (strcmp(hdf5->fill_time, "default"))
+        append_prop(buf, size, "fill_time=%s", hdf5->fill_time);
+    if (strcmp(hdf5->file_space_strategy, "default"))
+        append_prop(buf, size, "file_space_strategy=%s",
+                    hdf5->file_space_strategy);
+    if (hdf5->page_size)
+        append_prop(buf, size, "page_size=%lu", hdf5->page_size);
+    if (hdf5->page_buffer_size)
+        append_prop(buf, size, "page_buffer_size=%lu", hdf5->page_buffer_size);
+
+    if (!buf[0]) snprintf(buf, size, "default");
+}
+
+// a filter name or a list of them to sweep over
+static void parse_filters(struct json_object *workload,
+                          config_workload_t *config_workload) {
+    struct json_object *filter;
+    ASSERT(json_object_object_get_ex(workload, "filter", &filter),
+           CONFIG_ERROR_PREFIX "Failed to find filter in JSON config\n");
+
+    if (json_object_get_type(filter) == json_type_array) {
+        struct array_list *filters = validate_json_array(
+            workload, "filter", 1, MAX_CONFIG_IO_FILTERS);
+        config_workload->num_io_filters = array_list_length(filters);
+        for (uint32_t i = 0; i < config_workload->num_io_filters; i++)
+            strcpy(config_workload->io_filters[i],
+                   validate_json_string_raw(array_list_get_idx(filters, i),
+                                            MAX_CONFIG_STRING_SIZE));
+    } else {
+        config_workload->num_io_filters = 1;
+        strcpy(config_workload->io_filters[0],
+               validate_json_string(workload, "filter",
+                                    MAX_CONFIG_STRING_SIZE));
+    }
+
+    for (uint32_t i = 0; i < config_workload->num_io_filters; i++) {
+        const char *io_filter = config_workload->io_filters[i];
+        ASSERT(!strcmp(io_filter, "raw") ||
+                   !strcmp(io_filter, "zfp_compress") ||
+                   !strcmp(io_filter, "zfp_compress_transform"),
+               CONFIG_ERROR_PREFIX "Invalid filter %s\n", io_filter);
+    }
+    strcpy(config_workload->io_filter, config_workload->io_filters[0]);
+}
+
+static void parse_zfp_mode(struct json_object *json_obj, config_zfp_t *zfp) {
+    ASSERT(json_object_get_type(json_obj) == json_type_object,
+           CONFIG_ERROR_PREFIX "zfp modes must be objects\n");
+    const char *mode =
+        validate_json_string(json_obj, "mode", MAX_CONFIG_STRING_SIZE);
+    ASSERT(!strcmp(mode, "reversible") || !strcmp(mode, "rate") ||
+               !strcmp(mode, "precision") || !strcmp(mode, "accuracy"),
+           CONFIG_ERROR_PREFIX "Invalid zfp mode %s\n", mode);
+    strcpy(zfp->mode, mode);
+    zfp->param = 0.0;
+    if (!strcmp(zfp->mode, "reversible")) return;
+
+    // the parameter is named after the mode, e.g. {"mode": "rate", "rate": 8}
+    zfp->param = validate_json_double(json_obj, zfp->mode);
+    ASSERT(zfp->param > 0,
+           CONFIG_ERROR_PREFIX "zfp %s must be > 0\n", zfp->mode);
+    if (!strcmp(zfp->mode, "precision"))
+        ASSERT(zfp->param == (uint32_t) zfp->param && zfp->param <= 64,
+               CONFIG_ERROR_PREFIX "zfp precision must be 1 <= bits <= 64\n");
+}
+
+static void parse_zfp_modes(struct json_object *workload,
+                            config_workload_t *config_workload) {
+    config_workload->num_zfp_modes = 1;
+    config_workload->zfp_modes[0].param = 0.0;
+
+    bool any_zfp = false;
+    for (uint32_t i = 0; i < config_workload->num_io_filters; i++)
+        any_zfp |= !strncmp(config_workload->io_filters[i], "zfp", 3);
+
+    if (!any_zfp) {
+        ASSERT(!json_has_key(workload, "zfp"),
+               CONFIG_ERROR_PREFIX "zfp modes need a zfp filter\n");
+        strcpy(config_workload->zfp_modes[0].mode, "none");
+        return;
+    }
+
+    // what the filter ran with before modes were configurable
+    strcpy(config_workload->zfp_modes[0].mode, "reversible");
+
+    struct json_object *zfp;
+    if (!json_object_object_get_ex(workload, "zfp", &zfp)) return;
+    if (json_object_get_type(zfp) == json_type_object) {
+        parse_zfp_mode(zfp, &config_workload->zfp_modes[0]);
+        return;
+    }
+
+    struct array_list *modes =
+        validate_json_array(workload, "zfp", 1, MAX_CONFIG_ZFP_MODES);
+    config_workload->num_zfp_modes = array_list_length(modes);
+    for (uint32_t i = 0; i < config_workload->num_zfp_modes; i++)
+        parse_zfp_mode(array_list_get_idx(modes, i),
+                       &config_workload->zfp_modes[i]);
+}
+
+/**
+ * PDC's zfp_compress transform runs with its builtin settings, it is not
+ * known to read any mode from the graph. PDC workloads therefore only take
+ * the default mode, which is recorded as "pdc_default".
+ */
+static void validate_pdc_zfp_modes(config_workload_t *config_workload) {
+    if (strcmp(config_workload->implementation, "pdc") ||
+        !strcmp(config_workload->zfp_modes[0].mode, "none"))
+        return;
+    for (uint32_t i = 0; i < config_workload->num_zfp_modes; i++)
+        ASSERT(!strcmp(config_workload->zfp_modes[i].mode, "reversible"),
+               CONFIG_ERROR_PREFIX
+               "PDC's zfp_compress has no configurable mode, zfp %s is not "
+               "supported\n",
+               config_workload->zfp_modes[i].mode);
+    config_workload->num_zfp_modes = 1;
+    strcpy(config_workload->zfp_modes[0].mode, "pdc_default");
+}
+
+// fills values from the array of positive integers arr_name
+static uint32_t parse_positive_array(struct json_object *json_obj,
+                                     char *arr_name, uint32_t min_length,
+                                     uint32_t max_length, uint64_t *values) {
+    struct array_list *arr =
+        validate_json_array(json_obj, arr_name, min_length, max_length);
+    uint32_t length = array_list_length(arr);
+    for (uint32_t i = 0; i < length; i++) {
+        struct json_object *value = array_list_get_idx(arr, i);
+        ASSERT(json_object_get_type(value) == json_type_int &&
+                   json_object_get_int64(value) > 0,
+               CONFIG_ERROR_PREFIX "%s must hold positive integers\n",
+               arr_name);
+        values[i] = json_object_get_int64(value);
+    }
+    return length;
+}
+
+// a positive integer or a list of them to sweep over
+static uint32_t parse_sweep(struct json_object *json_obj, char *name,
+                            uint64_t *values) {
+    struct json_object *value;
+    ASSERT(json_object_object_get_ex(json_obj, name, &value),
+           CONFIG_ERROR_PREFIX "Failed to find %s in JSON config\n", name);
+    if (json_object_get_type(value) == json_type_array)
+        return parse_positive_array(json_obj, name, 1, MAX_CONFIG_SWEEP_VALUES,
+                                    values);
+
+    int number = validate_json_number(json_obj, name);
+    ASSERT(number > 0, CONFIG_ERROR_PREFIX "%s must be > 0\n", name);
+    values[0] = number;
+    return 1;
+}
+
+static void parse_layout(struct json_object *json_obj, config_t *config) {
+    config_layout_t *layout = &config->layout_config;
+    memset(layout, 0, sizeof(*layout));
+
+    struct json_object *layout_json;
+    if (!json_object_object_get_ex(json_obj, "layout", &layout_json)) {
+        config->num_chunk_sizes =
+            parse_sweep(json_obj, "chunk_size_bytes", config->chunk_sizes);
+        return;
+    }
+    ASSERT(json_object_get_type(layout_json) == json_type_object,
+           CONFIG_ERROR_PREFIX "layout must be an object\n");
+
+    layout->ndims = parse_positive_array(layout_json, "chunk_dims", 1,
+                                         MAX_CONFIG_DIMS, layout->chunk_dims);
+    if (json_has_key(layout_json, "global_dims"))
+        parse_positive_array(layout_json, "global_dims", layout->ndims,
+                             layout->ndims, layout->global_dims);
+    if (json_has_key(layout_json, "rank_grid"))
+        parse_positive_array(layout_json, "rank_grid", layout->ndims,
+                             layout->ndims, layout->rank_grid);
+
+    // the chunk shape fixes the chunk size, it cannot be swept
+    uint64_t chunk_bytes = sizeof(double);
+    for (uint32_t d = 0; d < layout->ndims; d++)
+        chunk_bytes *= layout->chunk_dims[d];
+    config->num_chunk_sizes = 1;
+    config->chunk_sizes[0] = chunk_bytes;
+    if (json_has_key(json_obj, "chunk_size_bytes"))
+        ASSERT(validate_json_number(json_obj, "chunk_size_bytes") ==
+                   (int) chunk_bytes,
+               CONFIG_ERROR_PREFIX
+               "chunk_size_bytes does not match chunk_dims (%lu bytes)\n",
+               chunk_bytes);
+}
+
+/**
+ * hdf5_direct moves each rank's chunks with independent H5Dwrite_chunk and
+ * H5Dread_chunk calls, which is only safe when no other rank opens the same
+ * file. The core driver gives every rank its own file, any other driver
+ * needs every sweep point to run on a single rank.
+ */
+static void validate_direct_workload(config_t *config,
+                                     config_workload_t *config_workload) {
+    if (strcmp(config_workload->implementation, "hdf5_direct")) return;
+    for (uint32_t j = 0; j < config_workload->num_io_participations; j++)
+        ASSERT(strcmp(config_workload->io_participations[j], "collective"),
+               CONFIG_ERROR_PREFIX
+               "hdf5_direct only supports independent io_participation\n");
+    if (!strcmp(config_workload->hdf5.file_driver, "core")) return;
+
+    // without a num_ranks sweep the only point runs on the whole job
+    int point_ranks;
+    MPI_Comm_size(MPI_COMM_WORLD, &point_ranks);
+    uint32_t num_points =
+        config->num_rank_counts ? config->num_rank_counts : 1;
+    for (uint32_t r = 0; r < num_points; r++) {
+        if (config->num_rank_counts) point_ranks = config->rank_counts[r];
+        ASSERT(point_ranks == 1,
+               CONFIG_ERROR_PREFIX
+               "hdf5_direct on the %s file_driver needs a single rank, "
+               "sweep point has %d, use the core file_driver\n",
+               config_workload->hdf5.file_driver, point_ranks);
+    }
+}
+
+/**
+ * PDCinit and PDCclose are collective over MPI_COMM_WORLD, so a PDC workload
+ * cannot run on a sweep point that leaves part of the job idle.
+ */
+static void validate_pdc_workload(config_t *config,
+                                  config_workload_t *config_workload) {
+    if (strcmp(config_workload->implementation, "pdc")) return;
+    int world_ranks;
+    MPI_Comm_size(MPI_COMM_WORLD, &world_ranks);
+    for (uint32_t r = 0; r < config->num_rank_counts; r++)
+        ASSERT(config->rank_counts[r] == world_ranks,
+               CONFIG_ERROR_PREFIX
+               "PDC workloads need every rank, num_ranks %d is below the "
+               "job's %d\n",
+               config->rank_counts[r], world_ranks);
+}
+
 config_t *init_config(char *config_path) {
     config_t *config = malloc(sizeof(config_t));
 
@@ -128,6 +834,11 @@ config_t *init_config(char *config_path) {
     // close file
     ASSERT(close(fd) == 0, "Failed to close config file\n");
 
+    // paths in the config are relative to its directory
+    char path_copy[PATH_MAX], config_dir[PATH_MAX];
+    snprintf(path_copy, sizeof(path_copy), "%s", config_path);
+    snprintf(config_dir, sizeof(config_dir), "%s", dirname(path_copy));
+
     // parse json string
     struct json_object *json_obj = json_tokener_parse(file_buf);
     ASSERT(json_obj != NULL, "Failed to parse json string\n");
@@ -157,8 +868,7 @@ config_t *init_config(char *config_path) {
         const char *workload_implementation = validate_json_string(
             workload, "implementation", MAX_CONFIG_STRING_SIZE);
         strcpy(config->workloads[i].implementation, workload_implementation);
-        const char *workload_io_filter =
-            validate_json_string(workload, "filter", MAX_CONFIG_STRING_SIZE);
+        parse_filters(workload, &config->workloads[i]);
         const char *workload_io_type =
             validate_json_string(workload, "io_type", MAX_CONFIG_STRING_SIZE);
         strcpy(config->workloads[i].io_type, workload_io_type);
@@ -166,6 +876,65 @@ config_t *init_config(char *config_path) {
             validate_json_string(workload, "params", MAX_CONFIG_STRING_SIZE);
         strcpy(config->workloads[i].params, params);
 
+        // optional driver mode, defaults to one chunk at a time
+        strcpy(config->workloads[i].driver, "sync");
+        if (json_has_key(workload, "driver")) {
+            const char *driver = validate_json_string(workload, "driver",
+                                                      MAX_CONFIG_STRING_SIZE);
+            ASSERT(!strcmp(driver, "sync") || !strcmp(driver, "pipelined") ||
+                       !strcmp(driver, "batched"),
+                   CONFIG_ERROR_PREFIX "Invalid driver %s\n", driver);
+            strcpy(config->workloads[i].driver, driver);
+        }
+        config->workloads[i].pipeline_depth = 2;
+        if (json_has_key(workload, "pipeline_depth")) {
+            int pipeline_depth =
+                validate_json_number(workload, "pipeline_depth");
+            ASSERT(pipeline_depth >= 1 &&
+                       pipeline_depth <= MAX_CONFIG_PIPELINE_DEPTH,
+                   CONFIG_ERROR_PREFIX
+                   "pipeline_depth must be 1 <= depth <= %d\n",
+                   MAX_CONFIG_PIPELINE_DEPTH);
+            config->workloads[i].pipeline_depth = pipeline_depth;
+        }
+        config->workloads[i].iterations = 1;
+        if (json_has_key(workload, "iterations")) {
+            int iterations = validate_json_number(workload, "iterations");
+            ASSERT(iterations >= 1,
+                   CONFIG_ERROR_PREFIX "iterations must be >= 1\n");
+            config->workloads[i].iterations = iterations;
+        }
+
+        parse_datagen(workload, &config->workloads[i].datagen);
+        parse_hdf5(workload, &config->workloads[i].hdf5);
+        parse_pdc(workload, config_dir, &config->workloads[i].pdc);
+        ASSERT(!config->workloads[i].pdc.reuse_transfers ||
+                   !strcmp(config->workloads[i].driver, "sync"),
+               CONFIG_ERROR_PREFIX "reuse_transfers needs the sync driver\n");
+
+        // optional read verification mode
+        strcpy(config->workloads[i].verify, "full");
+        if (json_has_key(workload, "verify")) {
+            const char *verify = validate_json_string(workload, "verify",
+                                                      MAX_CONFIG_STRING_SIZE);
+            ASSERT(!strcmp(verify, "full") || !strcmp(verify, "checksum") ||
+                       !strcmp(verify, "none"),
+                   CONFIG_ERROR_PREFIX "Invalid verify mode %s\n", verify);
+            strcpy(config->workloads[i].verify, verify);
+        }
+
+        parse_zfp_modes(workload, &config->workloads[i]);
+        validate_pdc_zfp_modes(&config->workloads[i]);
+        for (uint32_t j = 0; j < config->workloads[i].num_zfp_modes; j++)
+            ASSERT(strcmp(config->workloads[i].verify, "checksum") ||
+                       !strcmp(config->workloads[i].zfp_modes[j].mode,
+                               "none") ||
+                       !strcmp(config->workloads[i].zfp_modes[j].mode,
+                               "reversible"),
+                   CONFIG_ERROR_PREFIX
+                   "checksum verify needs lossless data, zfp mode is %s\n",
+                   config->workloads[i].zfp_modes[j].mode);
+
         // validate and pull out io participations
         struct array_list *workload_io_participations = validate_json_array(
             workload, "io_participations", 1, MAX_CONFIG_IO_PARTICIPATIONS);
@@ -183,9 +952,23 @@ config_t *init_config(char *config_path) {
         }
     }
     // get total bytes per chunk & validate read & chunks_per_rank
-    config->chunk_size_bytes =
-        validate_json_number(json_obj, "chunk_size_bytes");
-    config->chunks_per_rank = validate_json_number(json_obj, "chunks_per_rank");
+    parse_layout(json_obj, config);
+    config->num_chunks_per_rank_values = parse_sweep(
+        json_obj, "chunks_per_rank", config->chunks_per_rank_values);
+
+    // optional rank counts, each one runs on the first num_ranks ranks
+    config->num_rank_counts = 0;
+    if (json_has_key(json_obj, "num_ranks")) {
+        uint64_t rank_counts[MAX_CONFIG_SWEEP_VALUES];
+        config->num_rank_counts =
+            parse_sweep(json_obj, "num_ranks", rank_counts);
+        for (uint32_t i = 0; i < config->num_rank_counts; i++)
+            config->rank_counts[i] = rank_counts[i];
+    }
+    for (uint32_t i = 0; i < config->num_workloads; i++) {
+        validate_direct_workload(config, &config->workloads[i]);
+        validate_pdc_workload(config, &config->workloads[i]);
+    }
 
     /**
      * FIXME: at this point we have pulled out correct values from json
@@ -3,39 +3,224 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <mpi.h>
 
 #define CSV_FILENAME "output.csv"
+// prefixes errors in the user's configuration
+#define CONFIG_ERROR_PREFIX "[CONFIG_ERROR] "
 
 #define MAX_CONFIG_WORKLOADS 255
 #define MAX_CONFIG_IO_PARTICIPATIONS 2
 #define MAX_CONFIG_STRING_SIZE 256
+#define MAX_CONFIG_PIPELINE_DEPTH 64
+#define MAX_CONFIG_ZFP_MODES 16
+#define MAX_CONFIG_DIMS 4
+#define MAX_CONFIG_SWEEP_VALUES 32
+#define MAX_CONFIG_IO_FILTERS 4
+#define MAX_CONFIG_MPI_HINTS 16
+#define MAX_CONFIG_REGION_PARTITIONS 4
+#define MAX_CONFIG_SERVER_TIMERS_SIZE 2048
+
+/**
+ * Synthetic data generator, see datagen.h for what each type produces.
+ */
+typedef struct config_datagen_t {
+    char type[MAX_CONFIG_STRING_SIZE];
+    uint32_t seed;
+    double amplitude;
+    // wavelength of the smooth field in elements
+    double wavelength;
+    // Gaussian random field: P(k) ~ k^-spectral_slope over num_modes modes
+    double spectral_slope;
+    uint32_t num_modes;
+    // edge length in elements of each piecewise-constant region
+    uint32_t region_size;
+    // signal to noise ratio in dB of the noisy field
+    double snr_db;
+} config_datagen_t;
+
+/**
+ * One ZFP compression mode. param is the rate in bits per value, the number
+ * of bit planes kept or the absolute error tolerance for "rate", "precision"
+ * and "accuracy" and unused for "reversible". Workloads without ZFP run a
+ * single mode "none". PDC runs ZFP with its own settings, its mode is
+ * "pdc_default" and is treated as lossy.
+ */
+typedef struct config_zfp_t {
+    char mode[MAX_CONFIG_STRING_SIZE];
+    double param;
+} config_zfp_t;
+
+/**
+ * Shape of the dataset, see layout.h. The "layout" config object sets
+ * ndims, chunk_dims and optionally global_dims and rank_grid, entries left at
+ * 0 are derived by layout_init along with rank_chunks and chunk_elements.
+ */
+typedef struct config_layout_t {
+    uint32_t ndims;
+    uint64_t chunk_dims[MAX_CONFIG_DIMS];
+    uint64_t global_dims[MAX_CONFIG_DIMS];
+    // ranks along each dimension, ranks are laid out row-major
+    uint64_t rank_grid[MAX_CONFIG_DIMS];
+    // chunks each rank owns along each dimension, chunks are row-major
+    uint64_t rank_chunks[MAX_CONFIG_DIMS];
+    uint64_t chunk_elements;
+} config_layout_t;
+
+// optional "hdf5" object, only read by the HDF5 implementations
+typedef struct config_hdf5_t {
+    // "mpio" for one shared file, "subfiling" or "core" for one in-memory
+    // file per rank
+    char file_driver[MAX_CONFIG_STRING_SIZE];
+    // core files are written out to disk on close, needed to read them back
+    bool backing_store;
+    // subfiling stripe size and I/O concentrators per node, 0 keeps the
+    // library default
+    uint64_t stripe_size;
+    uint32_t ioc_per_node;
+    // raw data chunk cache of the dataset, 0 and a negative w0 keep the
+    // library default
+    uint64_t chunk_cache_bytes;
+    uint64_t chunk_cache_slots;
+    double chunk_cache_w0;
+    // metadata cache sizes, 0 keeps the library default
+    uint64_t mdc_initial_size;
+    uint64_t mdc_max_size;
+    // collective metadata reads and writes instead of every rank on its own
+    bool coll_metadata_ops;
+    bool coll_metadata_write;
+    // MPI_Info hints handed to the MPI-IO layer, e.g. "cb_nodes" or
+    // "striping_unit", as key/value pairs
+    uint32_t num_mpi_hints;
+    char mpi_hints[MAX_CONFIG_MPI_HINTS][2][MAX_CONFIG_STRING_SIZE];
+    // objects of at least alignment_threshold bytes start on a multiple of
+    // alignment, 0 leaves them unaligned
+    uint64_t alignment_threshold;
+    uint64_t alignment;
+    // "default", "early", "incr" or "late" space allocation
+    char alloc_time[MAX_CONFIG_STRING_SIZE];
+    // "default", "alloc", "ifset" or "never" writes of the fill value
+    char fill_time[MAX_CONFIG_STRING_SIZE];
+    // "page" aggregates metadata and raw data into page_size pages
+    char file_space_strategy[MAX_CONFIG_STRING_SIZE];
+    uint64_t page_size;
+    // page buffer on file access, 0 disables it, core driver only
+    uint64_t page_buffer_size;
+} config_hdf5_t;
+
+// optional "pdc" object, only read by the PDC implementations
+typedef struct config_pdc_t {
+    // region transfers started but not yet waited on, 0 keeps all of them
+    // in flight until flush
+    uint64_t max_inflight;
+    // keep each chunk's region transfer and restart it on later iterations
+    // instead of creating a new one per chunk, sync driver only
+    bool reuse_transfers;
+    // how the servers partition the object's regions, "region_local",
+    // "region_static", "region_dynamic" or "obj_static". A list is swept
+    // like filters, region_partition is the one currently running
+    uint32_t num_region_partitions;
+    char region_partitions[MAX_CONFIG_REGION_PARTITIONS]
+                          [MAX_CONFIG_STRING_SIZE];
+    char region_partition[MAX_CONFIG_STRING_SIZE];
+    // transform graph attached to zfp objects, an absolute path, and the
+    // states the data is transformed from and to
+    char tf_graph[MAX_CONFIG_STRING_SIZE];
+    char tf_source_state[MAX_CONFIG_STRING_SIZE];
+    char tf_target_state[MAX_CONFIG_STRING_SIZE];
+} config_pdc_t;
 
 typedef struct config_workload_t {
     char name[MAX_CONFIG_STRING_SIZE];
     char params[MAX_CONFIG_STRING_SIZE];
     char implementation[MAX_CONFIG_STRING_SIZE];
+    // "filter" may be a list, io_filter is the one currently running
+    uint32_t num_io_filters;
+    char io_filters[MAX_CONFIG_IO_FILTERS][MAX_CONFIG_STRING_SIZE];
     char io_filter[MAX_CONFIG_STRING_SIZE];
     uint32_t num_io_participations;
     char io_participations[MAX_CONFIG_IO_PARTICIPATIONS]
                           [MAX_CONFIG_STRING_SIZE];
     char io_type[MAX_CONFIG_STRING_SIZE];
+    // "sync" issues one chunk at a time, "pipelined" keeps pipeline_depth
+    // chunks in flight through the submit/complete hooks and "batched" hands
+    // all chunks over at once through write_chunks/read_chunks
+    char driver[MAX_CONFIG_STRING_SIZE];
+    uint32_t pipeline_depth;
+    // times the I/O phase is repeated on the same dataset and buffers, like
+    // the timesteps of a simulation
+    uint32_t iterations;
+    config_datagen_t datagen;
+    // "full", "checksum" or "none", see verify.h
+    char verify[MAX_CONFIG_STRING_SIZE];
+    // every mode is run as its own workload, like io_participations
+    uint32_t num_zfp_modes;
+    config_zfp_t zfp_modes[MAX_CONFIG_ZFP_MODES];
+    config_hdf5_t hdf5;
+    config_pdc_t pdc;
 } config_workload_t;
 
 // this should mirror JSON
 typedef struct config_t {
     uint32_t num_workloads;
     config_workload_t workloads[MAX_CONFIG_WORKLOADS];
+    // every combination of these is a sweep point, see main.c
+    uint32_t num_chunk_sizes;
+    uint64_t chunk_sizes[MAX_CONFIG_SWEEP_VALUES];
+    uint32_t num_chunks_per_rank_values;
+    uint64_t chunks_per_rank_values[MAX_CONFIG_SWEEP_VALUES];
+    // 0 runs with every rank of the job
+    uint32_t num_rank_counts;
+    int rank_counts[MAX_CONFIG_SWEEP_VALUES];
+    // ndims is 0 without a "layout" object
+    config_layout_t layout_config;
+    // this should not mirror JSON
+    uint32_t sweep_point;
+    // ranks of the current sweep point, rank 0 is always world rank 0
+    MPI_Comm comm;
     uint64_t chunk_size_bytes;
     uint64_t chunks_per_rank;
-    // this should not mirror JSON
-    uint64_t elements_per_dim;
+    config_layout_t layout;
     uint64_t total_bytes;
+    // bytes the dataset occupies on storage, 0 if the backend cannot tell
+    uint64_t stored_bytes;
+    // backend counters of the current workload as ';' separated key=value
+    // pairs, empty if the backend reports none
+    char backend_stats[MAX_CONFIG_STRING_SIZE];
+    // PDC server timers of the current workload as ';' separated
+    // "name=min/avg/max" seconds over the servers, empty without them
+    char server_timers[MAX_CONFIG_SERVER_TIMERS_SIZE];
     int num_ranks;
     int my_rank;
     uint64_t cur_chunk;
     char io_participation[MAX_CONFIG_STRING_SIZE];
+    config_zfp_t zfp;
 } config_t;
 
 config_t *init_config(char *config_path);
+/**
+ * True if the workload's filter compresses with ZFP.
+ */
+bool config_filter_is_zfp(config_workload_t *config_workload);
+/**
+ * True if the current ZFP mode loses data.
+ */
+bool config_zfp_is_lossy(config_t *config);
+/**
+ * The workload's HDF5 file driver, "none" for non-HDF5 implementations.
+ */
+const char *config_file_driver(config_workload_t *config_workload);
+/**
+ * The workload's current PDC region partition, "none" for non-PDC
+ * implementations.
+ */
+const char *config_region_partition(config_workload_t *config_workload);
+/**
+ * Formats the workload's non-default "hdf5" or "pdc" properties, whichever
+ * its implementation reads, as "key=value" pairs separated by ';'. Gives
+ * "default" if there are none.
+ */
+void config_backend_props_string(config_workload_t *config_workload,
+                                 char *buf, size_t size);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,247 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mpi.h>
+
+#include "datagen.h"
+#include "layout.h"
+#include "log.h"
+#include "philox.h"
+
+/**
+ * All generators see a chunk as rows of contiguous elements along its last
+ * dimension, the outer dimensions of each row follow row-major from the row
+ * index. Rows are split across OpenMP threads and inner loops are kept branch
+ * free over contiguous memory so the compiler can vectorize them. Positions
+ * are global, so fields continue seamlessly across chunk and rank borders.
+ *
+ * Random values come from Philox keyed on (seed, rank) with the chunk and
+ * element pair index as the counter, so every rank and chunk gets unique data
+ * that can be regenerated independently on the read side.
+ */
+
+// Philox stream reserved for values shared by every rank, e.g. GRF modes
+#define DATAGEN_FIELD_STREAM UINT32_MAX
+
+typedef struct datagen_block_t {
+    uint32_t ndims;
+    // global offset and shape of the chunk
+    uint64_t offset[MAX_CONFIG_DIMS];
+    uint64_t dims[MAX_CONFIG_DIMS];
+    uint64_t num_rows;
+    uint64_t row_length;
+} datagen_block_t;
+
+// global coordinates of the row's outer dimensions
+static void row_coords(const datagen_block_t *block, uint64_t row,
+                       uint64_t *coords) {
+    for (int d = (int) block->ndims - 2; d >= 0; d--) {
+        coords[d] = block->offset[d] + row % block->dims[d];
+        row /= block->dims[d];
+    }
+}
+
+static void fill_random(const config_datagen_t *gen, uint32_t rank,
+                        uint64_t chunk, uint64_t num_elements,
+                        double *buffer) {
+#pragma omp parallel for simd
+    for (uint64_t e = 0; e < num_elements; e++) {
+        double u0, u1;
+        philox_uniform2(gen->seed, rank, chunk, e, &u0, &u1);
+        buffer[e] = u0 * RAND_MAX + u1;
+    }
+}
+
+static void fill_smooth(const config_datagen_t *gen,
+                        const datagen_block_t *block, double *buffer) {
+    const double k = 2.0 * M_PI / gen->wavelength;
+    const uint64_t n = block->row_length;
+    const uint64_t x0 = block->offset[block->ndims - 1];
+    double *cols = malloc(n * sizeof(double));
+    for (uint64_t j = 0; j < n; j++) cols[j] = cos(k * (double) (x0 + j));
+
+#pragma omp parallel for
+    for (uint64_t i = 0; i < block->num_rows; i++) {
+        uint64_t coords[MAX_CONFIG_DIMS];
+        row_coords(block, i, coords);
+        double y = 0.0;
+        for (uint32_t d = 0; d + 1 < block->ndims; d++) y += coords[d];
+
+        const double r =
+            gen->amplitude * (block->ndims > 1 ? sin(k * y) : 1.0);
+        double *restrict out = &buffer[i * n];
+        for (uint64_t j = 0; j < n; j++) out[j] = r * cols[j];
+    }
+    free(cols);
+}
+
+/**
+ * Random-phase spectral synthesis: a sum of num_modes plane waves with
+ * wavenumbers drawn log-uniformly between 2 pi / wavelength and pi and
+ * isotropic directions. With log-uniform sampling in d dimensions each mode
+ * stands for P(k) k^d of power, so its amplitude is k^((d - slope) / 2),
+ * normalized to a variance of amplitude^2. Each wave is split into cos/sin
+ * tables along the last dimension so a row costs one multiply-add per mode
+ * and element.
+ */
+static void fill_grf(const config_datagen_t *gen, const datagen_block_t *block,
+                     double *buffer) {
+    const uint32_t m = gen->num_modes;
+    const uint32_t nd = block->ndims;
+    const uint64_t n = block->row_length;
+    const uint64_t x0 = block->offset[nd - 1];
+    double *kv = malloc(m * nd * sizeof(double));
+    double *phase = malloc(m * sizeof(double));
+    double *weight = malloc(m * sizeof(double));
+    double *cos_cols = malloc(m * n * sizeof(double));
+    double *sin_cols = malloc(m * n * sizeof(double));
+
+    // modes depend only on the seed so every chunk samples the same field
+    const double log_kmin = log(fmin(2.0 * M_PI / gen->wavelength, M_PI));
+    const double log_kmax = log(M_PI);
+    double weight_sum = 0.0;
+    for (uint32_t q = 0; q < m; q++) {
+        double u_k, u_phase;
+        philox_uniform2(gen->seed, DATAGEN_FIELD_STREAM, 0, q, &u_k, &u_phase);
+        double k = exp(log_kmin + (log_kmax - log_kmin) * u_k);
+
+        // normalized Gaussian components give a uniform direction
+        double dir[MAX_CONFIG_DIMS], norm_sq = 0.0;
+        for (uint32_t d = 0; d < nd; d++) {
+            double u_r, u_theta;
+            philox_uniform2(gen->seed, DATAGEN_FIELD_STREAM, 1 + d, q, &u_r,
+                            &u_theta);
+            dir[d] = sqrt(-2.0 * log(1.0 - u_r)) * cos(2.0 * M_PI * u_theta);
+            norm_sq += dir[d] * dir[d];
+        }
+        for (uint32_t d = 0; d < nd; d++)
+            kv[q * nd + d] = norm_sq > 0 ? k * dir[d] / sqrt(norm_sq)
+                                         : (d == nd - 1 ? k : 0.0);
+
+        phase[q] = 2.0 * M_PI * u_phase;
+        weight[q] = pow(k, ((double) nd - gen->spectral_slope) / 2.0);
+        weight_sum += weight[q] * weight[q];
+    }
+    const double norm = gen->amplitude * sqrt(2.0 / weight_sum);
+
+#pragma omp parallel for
+    for (uint32_t q = 0; q < m; q++) {
+        const double kx = kv[q * nd + nd - 1];
+        for (uint64_t j = 0; j < n; j++) {
+            const double x = (double) (x0 + j);
+            cos_cols[q * n + j] = norm * weight[q] * cos(kx * x);
+            sin_cols[q * n + j] = norm * weight[q] * sin(kx * x);
+        }
+    }
+
+#pragma omp parallel for
+    for (uint64_t i = 0; i < block->num_rows; i++) {
+        uint64_t coords[MAX_CONFIG_DIMS];
+        row_coords(block, i, coords);
+        double *restrict out = &buffer[i * n];
+        memset(out, 0, n * sizeof(double));
+        for (uint32_t q = 0; q < m; q++) {
+            double arg = phase[q];
+            for (uint32_t d = 0; d + 1 < nd; d++)
+                arg += kv[q * nd + d] * (double) coords[d];
+            const double cr = cos(arg), sr = sin(arg);
+            const double *restrict c = &cos_cols[q * n];
+            const double *restrict s = &sin_cols[q * n];
+            for (uint64_t j = 0; j < n; j++) out[j] += cr * c[j] - sr * s[j];
+        }
+    }
+
+    free(kv);
+    free(phase);
+    free(weight);
+    free(cos_cols);
+    free(sin_cols);
+}
+
+// splitmix64 finalizer, maps a region coordinate to a well mixed value
+static uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static void fill_piecewise(const config_datagen_t *gen,
+                           const datagen_block_t *block, double *buffer) {
+    const uint64_t r = gen->region_size;
+    const uint64_t n = block->row_length;
+    const uint64_t x0 = block->offset[block->ndims - 1];
+#pragma omp parallel for
+    for (uint64_t i = 0; i < block->num_rows; i++) {
+        uint64_t coords[MAX_CONFIG_DIMS];
+        row_coords(block, i, coords);
+        uint64_t outer = 0;
+        for (uint32_t d = 0; d + 1 < block->ndims; d++)
+            outer = mix64(outer ^ (coords[d] / r));
+
+        double *restrict out = &buffer[i * n];
+        for (uint64_t j = 0; j < n;) {
+            const uint64_t x = x0 + j;
+            const uint64_t h = mix64(gen->seed ^ outer ^ (x / r));
+            const double v = gen->amplitude * (double) (h >> 11) * 0x1.0p-53;
+            const uint64_t end = j + r - x % r < n ? j + r - x % r : n;
+            for (; j < end; j++) out[j] = v;
+        }
+    }
+}
+
+/**
+ * The smooth field has an RMS of amplitude / 2 (amplitude / sqrt(2) in 1D),
+ * the noise standard deviation is picked so that 20 log10(signal_rms / sigma)
+ * equals snr_db.
+ */
+static void fill_noise(const config_datagen_t *gen, uint32_t rank,
+                       uint64_t chunk, const datagen_block_t *block,
+                       double *buffer) {
+    fill_smooth(gen, block, buffer);
+
+    const double signal_rms =
+        gen->amplitude / (block->ndims > 1 ? 2.0 : sqrt(2.0));
+    const double sigma = signal_rms / pow(10.0, gen->snr_db / 20.0);
+    const uint64_t num_elements = block->num_rows * block->row_length;
+    const uint64_t pairs = (num_elements + 1) / 2;
+#pragma omp parallel for
+    for (uint64_t b = 0; b < pairs; b++) {
+        // Box-Muller, 1 - u keeps the log argument away from zero
+        double u0, u1;
+        philox_uniform2(gen->seed, rank, chunk, b, &u0, &u1);
+        double radius = sigma * sqrt(-2.0 * log(1.0 - u0));
+        buffer[2 * b] += radius * cos(2.0 * M_PI * u1);
+        if (2 * b + 1 < num_elements)
+            buffer[2 * b + 1] += radius * sin(2.0 * M_PI * u1);
+    }
+}
+
+void datagen_fill_chunk(config_t *config, config_workload_t *config_workload,
+                        uint64_t chunk, double *buffer) {
+    const config_datagen_t *gen = &config_workload->datagen;
+    const config_layout_t *layout = &config->layout;
+    const uint32_t rank = config->my_rank;
+
+    datagen_block_t block;
+    block.ndims = layout->ndims;
+    layout_chunk_offset(config, chunk, block.offset);
+    memcpy(block.dims, layout->chunk_dims, sizeof(block.dims));
+    block.row_length = layout->chunk_dims[layout->ndims - 1];
+    block.num_rows = layout->chunk_elements / block.row_length;
+
+    if (!strcmp(gen->type, "random"))
+        fill_random(gen, rank, chunk, layout->chunk_elements, buffer);
+    else if (!strcmp(gen->type, "smooth"))
+        fill_smooth(gen, &block, buffer);
+    else if (!strcmp(gen->type, "grf"))
+        fill_grf(gen, &block, buffer);
+    else if (!strcmp(gen->type, "piecewise"))
+        fill_piecewise(gen, &block, buffer);
+    else if (!strcmp(gen->type, "noise"))
+        fill_noise(gen, rank, chunk, &block, buffer);
+    else {
+        PRINT_ERROR("Invalid generator type: %s\n", gen->type);
+        abort();
+    }
+}
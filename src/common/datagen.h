@@ -0,0 +1,26 @@
+#ifndef DATAGEN_H
+#define DATAGEN_H
+
+#include <stdint.h>
+
+#include "config.h"
+
+/**
+ * Synthetic chunk contents used to exercise the compressors. Every generator
+ * is a pure function of the workload's generator config and the chunk's
+ * global position, so the read path can regenerate any chunk to verify it.
+ * x is the coordinate along the last dimension and y the sum of the others.
+ *
+ *  - random:    uniform values in [0, RAND_MAX + 1), unique per rank and
+ *               chunk, essentially incompressible
+ *  - smooth:    amplitude * sin(2 pi y / wavelength) * cos(2 pi x /
+ *               wavelength), only the cosine for 1D datasets
+ *  - grf:       Gaussian random field with power spectrum P(k) ~ k^-slope,
+ *               scales from wavelength down to 2 elements
+ *  - piecewise: constant values over region_size^d blocks
+ *  - noise:     the smooth field plus white Gaussian noise at snr_db
+ */
+void datagen_fill_chunk(config_t *config, config_workload_t *config_workload,
+                        uint64_t chunk, double *buffer);
+
+#endif
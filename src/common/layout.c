@@ -0,0 +1,166 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mpi.h>
+
+#include "layout.h"
+#include "log.h"
+
+// ZFP compresses blocks of 4^d values, partial blocks are padded
+#define ZFP_BLOCK_EDGE 4
+
+// square 2D chunks of chunk_size_bytes, what the benchmark always used
+static void layout_init_legacy(config_t *config) {
+    config_layout_t *layout = &config->layout;
+    uint64_t n = (uint64_t) sqrt(config->chunk_size_bytes / sizeof(double));
+
+    if (n * n * sizeof(double) != config->chunk_size_bytes)
+        PRINT_RANK0("Warning: chunk_size_bytes %lu is not a square number of "
+                    "doubles, chunks hold %lu bytes\n",
+                    config->chunk_size_bytes, n * n * sizeof(double));
+
+    layout->ndims = 2;
+    layout->chunk_dims[0] = n;
+    layout->chunk_dims[1] = n;
+    layout->rank_grid[0] = config->num_ranks;
+    layout->rank_grid[1] = 1;
+    layout->rank_chunks[0] = config->chunks_per_rank;
+    layout->rank_chunks[1] = 1;
+}
+
+static void layout_init_explicit(config_t *config) {
+    config_layout_t *layout = &config->layout;
+    *layout = config->layout_config;
+
+    uint64_t grid_size = 1;
+    for (uint32_t d = 0; d < layout->ndims; d++)
+        grid_size *= layout->rank_grid[d];
+    if (grid_size == 0) {
+        // stack ranks along the first dimension
+        layout->rank_grid[0] = config->num_ranks;
+        for (uint32_t d = 1; d < layout->ndims; d++) layout->rank_grid[d] = 1;
+    } else {
+        ASSERT(grid_size == (uint64_t) config->num_ranks,
+               "rank_grid holds %lu ranks, running with %d\n", grid_size,
+               config->num_ranks);
+    }
+
+    if (layout->global_dims[0] == 0) {
+        layout->rank_chunks[0] = config->chunks_per_rank;
+        for (uint32_t d = 1; d < layout->ndims; d++)
+            layout->rank_chunks[d] = 1;
+        return;
+    }
+
+    uint64_t num_chunks = 1;
+    for (uint32_t d = 0; d < layout->ndims; d++) {
+        uint64_t block = layout->rank_grid[d] * layout->chunk_dims[d];
+        ASSERT(layout->global_dims[d] % block == 0,
+               "global dim %u (%lu) is not a multiple of rank_grid * "
+               "chunk_dims (%lu)\n",
+               d, layout->global_dims[d], block);
+        layout->rank_chunks[d] = layout->global_dims[d] / block;
+        num_chunks *= layout->rank_chunks[d];
+    }
+    ASSERT(num_chunks == config->chunks_per_rank,
+           "global_dims give each rank %lu chunks, chunks_per_rank is %lu\n",
+           num_chunks, config->chunks_per_rank);
+}
+
+void layout_init(config_t *config, config_workload_t *config_workload) {
+    config_layout_t *layout = &config->layout;
+
+    if (config->layout_config.ndims == 0)
+        layout_init_legacy(config);
+    else
+        layout_init_explicit(config);
+
+    layout->chunk_elements = 1;
+    for (uint32_t d = 0; d < layout->ndims; d++) {
+        layout->global_dims[d] = layout->rank_grid[d] *
+                                 layout->rank_chunks[d] *
+                                 layout->chunk_dims[d];
+        layout->chunk_elements *= layout->chunk_dims[d];
+    }
+    config->total_bytes = layout->chunk_elements * sizeof(double) *
+                          config->chunks_per_rank * config->num_ranks;
+
+    if (!config_filter_is_zfp(config_workload)) return;
+    for (uint32_t d = 0; d < layout->ndims; d++)
+        if (layout->chunk_dims[d] % ZFP_BLOCK_EDGE)
+            PRINT_RANK0("Warning: chunk dim %u (%lu) is not a multiple of %d, "
+                        "ZFP pads the partial blocks\n",
+                        d, layout->chunk_dims[d], ZFP_BLOCK_EDGE);
+}
+
+void layout_chunk_offset(config_t *config, uint64_t chunk, uint64_t *offset) {
+    const config_layout_t *layout = &config->layout;
+    uint64_t rank = config->my_rank;
+
+    for (int d = layout->ndims - 1; d >= 0; d--) {
+        uint64_t rank_pos = rank % layout->rank_grid[d];
+        uint64_t chunk_pos = chunk % layout->rank_chunks[d];
+        rank /= layout->rank_grid[d];
+        chunk /= layout->rank_chunks[d];
+        offset[d] = (rank_pos * layout->rank_chunks[d] + chunk_pos) *
+                    layout->chunk_dims[d];
+    }
+}
+
+bool layout_rank_block_contiguous(config_t *config) {
+    for (uint32_t d = 1; d < config->layout.ndims; d++)
+        if (config->layout.rank_chunks[d] > 1) return false;
+    return true;
+}
+
+void layout_copy_rank_block(config_t *config, double *chunks, double *block,
+                            bool to_block) {
+    const config_layout_t *layout = &config->layout;
+    uint32_t last = layout->ndims - 1;
+    uint64_t row_length = layout->chunk_dims[last];
+    uint64_t num_rows = layout->chunk_elements / row_length;
+    uint64_t block_dims[MAX_CONFIG_DIMS];
+    for (uint32_t d = 0; d < layout->ndims; d++)
+        block_dims[d] = layout->rank_chunks[d] * layout->chunk_dims[d];
+
+#pragma omp parallel for
+    for (uint64_t chunk = 0; chunk < config->chunks_per_rank; chunk++) {
+        uint64_t chunk_pos[MAX_CONFIG_DIMS], coord[MAX_CONFIG_DIMS];
+        uint64_t rem = chunk;
+        for (int d = last; d >= 0; d--) {
+            chunk_pos[d] = rem % layout->rank_chunks[d];
+            rem /= layout->rank_chunks[d];
+        }
+
+        double *chunk_buf = &chunks[chunk * layout->chunk_elements];
+        for (uint64_t row = 0; row < num_rows; row++) {
+            rem = row;
+            coord[last] = 0;
+            for (int d = last - 1; d >= 0; d--) {
+                coord[d] = rem % layout->chunk_dims[d];
+                rem /= layout->chunk_dims[d];
+            }
+
+            // block index of the row's first element
+            uint64_t index = 0;
+            for (uint32_t d = 0; d <= last; d++)
+                index = index * block_dims[d] +
+                        chunk_pos[d] * layout->chunk_dims[d] + coord[d];
+
+            double *chunk_row = &chunk_buf[row * row_length];
+            if (to_block)
+                memcpy(&block[index], chunk_row, row_length * sizeof(double));
+            else
+                memcpy(chunk_row, &block[index], row_length * sizeof(double));
+        }
+    }
+}
+
+void layout_dims_string(const uint64_t *dims, uint32_t ndims, char *buf,
+                        size_t size) {
+    size_t len = 0;
+    buf[0] = '\0';
+    for (uint32_t d = 0; d < ndims && len < size; d++)
+        len += snprintf(&buf[len], size - len, d ? "x%lu" : "%lu", dims[d]);
+}
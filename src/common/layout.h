@@ -0,0 +1,50 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+
+/**
+ * Dataset decomposition. The global dataset of 1 to MAX_CONFIG_DIMS
+ * dimensions is split into a rank_grid of equally sized per-rank blocks, each
+ * holding rank_chunks chunks of chunk_dims elements. Without a "layout"
+ * config the dataset is 2D with square chunks of chunk_size_bytes stacked
+ * along the first dimension, rank after rank.
+ */
+
+/**
+ * Resolves config->layout and config->total_bytes for the current number of
+ * ranks and chunks_per_rank. Aborts if the layout does not divide evenly and
+ * warns about chunk shapes that do not map onto whole ZFP blocks.
+ */
+void layout_init(config_t *config, config_workload_t *config_workload);
+
+/**
+ * Global element offset of this rank's chunk-th chunk.
+ */
+void layout_chunk_offset(config_t *config, uint64_t chunk, uint64_t *offset);
+
+/**
+ * True if this rank's chunks stored back to back are already its block in
+ * row-major order, which holds when only the first dimension has more than
+ * one chunk per rank.
+ */
+bool layout_rank_block_contiguous(config_t *config);
+
+/**
+ * Copies this rank's chunks between chunk order, chunks_per_rank chunks back
+ * to back, and the row-major order of the rank's block in the dataset.
+ */
+void layout_copy_rank_block(config_t *config, double *chunks, double *block,
+                            bool to_block);
+
+/**
+ * Formats dims as e.g. "64x64x64".
+ */
+void layout_dims_string(const uint64_t *dims, uint32_t ndims, char *buf,
+                        size_t size);
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <stdint.h>
+
+/**
+ * Philox4x32-10 counter-based RNG (Salmon et al., SC'11). The output is a
+ * pure function of a 64-bit key and a 128-bit counter, so any element of any
+ * chunk can be generated independently, in any order, from any thread. The
+ * round function only uses 32x32->64 multiplies and xors, which the compiler
+ * vectorizes when the counter is the loop index.
+ */
+
+typedef struct philox_ctr_t {
+    uint32_t v[4];
+} philox_ctr_t;
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+
+static inline philox_ctr_t philox4x32_10(philox_ctr_t ctr, uint32_t key0,
+                                         uint32_t key1) {
+    for (int round = 0; round < 10; round++) {
+        uint64_t p0 = (uint64_t) PHILOX_M0 * ctr.v[0];
+        uint64_t p1 = (uint64_t) PHILOX_M1 * ctr.v[2];
+        philox_ctr_t next = {{(uint32_t) (p1 >> 32) ^ ctr.v[1] ^ key0,
+                              (uint32_t) p1,
+                              (uint32_t) (p0 >> 32) ^ ctr.v[3] ^ key1,
+                              (uint32_t) p0}};
+        ctr = next;
+        key0 += PHILOX_W0;
+        key1 += PHILOX_W1;
+    }
+    return ctr;
+}
+
+/**
+ * Two uniform doubles in [0, 1) from the stream keyed on (seed, stream) at
+ * position (block, chunk). Each uses 53 random bits.
+ */
+static inline void philox_uniform2(uint32_t seed, uint32_t stream,
+                                   uint64_t chunk, uint64_t block,
+                                   double *u0, double *u1) {
+    philox_ctr_t ctr = {{(uint32_t) block, (uint32_t) (block >> 32),
+                         (uint32_t) chunk, (uint32_t) (chunk >> 32)}};
+    philox_ctr_t out = philox4x32_10(ctr, seed, stream);
+    uint64_t r0 = ((uint64_t) out.v[0] << 32) | out.v[1];
+    uint64_t r1 = ((uint64_t) out.v[2] << 32) | out.v[3];
+    *u0 = (double) (r0 >> 11) * 0x1.0p-53;
+    *u1 = (double) (r1 >> 11) * 0x1.0p-53;
+}
+
+#endif
@@ -0,0 +1,148 @@
+#include <stdlib.h>
+#include <string.h>
+#include <mpi.h>
+
+#include "timer.h"
+#include "log.h"
+
+#define MAX_TIMER_DEPTH 32
+
+// one entry per (parent, name) pair, the rows of the output
+static timer_entry_t *timers_g = NULL;
+static uint32_t num_timers_g = 0;
+static uint32_t timers_capacity_g = 0;
+
+/**
+ * Registered names, the ids START_TIMER caches. Each name remembers the
+ * entry it last ran as, which is the one it runs as again unless it is
+ * started under a different parent.
+ */
+typedef struct timer_name_t {
+    char name[MAX_TIMER_NAME_SIZE];
+    int last_entry;
+} timer_name_t;
+
+static timer_name_t *names_g = NULL;
+static uint32_t num_names_g = 0;
+static uint32_t names_capacity_g = 0;
+
+// entries of the running timers, innermost last
+static int stack_g[MAX_TIMER_DEPTH];
+static uint32_t stack_depth_g = 0;
+
+int timer_register(const char *name) {
+    for (uint32_t i = 0; i < num_names_g; i++)
+        if (!strcmp(names_g[i].name, name)) return i;
+
+    ASSERT(strlen(name) < MAX_TIMER_NAME_SIZE, "Timer name %s too long\n",
+           name);
+    if (num_names_g == names_capacity_g) {
+        names_capacity_g = names_capacity_g ? names_capacity_g * 2 : 32;
+        names_g = realloc(names_g, names_capacity_g * sizeof(*names_g));
+        ASSERT(names_g, "Failed to grow timer names\n");
+    }
+
+    strcpy(names_g[num_names_g].name, name);
+    names_g[num_names_g].last_entry = -1;
+    return num_names_g++;
+}
+
+/**
+ * Entry of name id under the innermost running timer, created the first
+ * time the name runs there.
+ */
+static int timer_entry(int id) {
+    int parent = stack_depth_g ? stack_g[stack_depth_g - 1] : -1;
+    int entry = names_g[id].last_entry;
+    if (entry >= 0 && timers_g[entry].parent == parent) return entry;
+
+    for (entry = 0; entry < (int) num_timers_g; entry++)
+        if (timers_g[entry].name_id == id && timers_g[entry].parent == parent)
+            break;
+    if (entry == (int) num_timers_g) {
+        if (num_timers_g == timers_capacity_g) {
+            timers_capacity_g =
+                timers_capacity_g ? timers_capacity_g * 2 : 32;
+            timers_g =
+                realloc(timers_g, timers_capacity_g * sizeof(*timers_g));
+            ASSERT(timers_g, "Failed to grow timer registry\n");
+        }
+        timer_entry_t *timer = &timers_g[num_timers_g++];
+        memset(timer, 0, sizeof(*timer));
+        strcpy(timer->name, names_g[id].name);
+        timer->name_id = id;
+        timer->parent = parent;
+    }
+    names_g[id].last_entry = entry;
+    return entry;
+}
+
+static void timer_add_sample(timer_entry_t *timer, double seconds) {
+    if (timer->count == timer->samples_capacity) {
+        timer->samples_capacity =
+            timer->samples_capacity ? timer->samples_capacity * 2 : 16;
+        timer->samples = realloc(timer->samples,
+                                 timer->samples_capacity * sizeof(double));
+        ASSERT(timer->samples, "Failed to grow samples of timer %s\n",
+               timer->name);
+    }
+    timer->samples[timer->count++] = seconds;
+    timer->total += seconds;
+}
+
+void timer_start(int id) {
+    int entry = timer_entry(id);
+    ASSERT(stack_depth_g < MAX_TIMER_DEPTH, "Timers nested too deep at %s\n",
+           names_g[id].name);
+    stack_g[stack_depth_g++] = entry;
+    timers_g[entry].start_time = MPI_Wtime();
+}
+
+void timer_stop(int id) {
+    double now = MPI_Wtime();
+
+    // timers normally stop innermost first, tolerate overlapping ones
+    uint32_t pos = stack_depth_g;
+    while (pos > 0 && timers_g[stack_g[pos - 1]].name_id != id) pos--;
+    if (pos == 0) {
+        PRINT_ERROR("Timer %s stopped but never started\n", names_g[id].name);
+        return;
+    }
+    timer_entry_t *timer = &timers_g[stack_g[pos - 1]];
+    memmove(&stack_g[pos - 1], &stack_g[pos],
+            (stack_depth_g - pos) * sizeof(int));
+    stack_depth_g--;
+
+    timer_add_sample(timer, now - timer->start_time);
+}
+
+void timer_record(const char *name, double seconds) {
+    timer_add_sample(&timers_g[timer_entry(timer_register(name))], seconds);
+}
+
+void timers_reset(void) {
+    for (uint32_t i = 0; i < num_timers_g; i++) {
+        timers_g[i].count = 0;
+        timers_g[i].total = 0.0;
+    }
+    stack_depth_g = 0;
+}
+
+uint32_t timers_count(void) { return num_timers_g; }
+
+const timer_entry_t *timer_get(int id) { return &timers_g[id]; }
+
+void timer_path(int id, char *path, uint32_t path_size) {
+    int chain[MAX_TIMER_DEPTH];
+    int depth = 0;
+    for (int cur = id; cur >= 0 && depth < MAX_TIMER_DEPTH;
+         cur = timers_g[cur].parent)
+        chain[depth++] = cur;
+
+    path[0] = '\0';
+    for (int i = depth - 1; i >= 0; i--) {
+        strncat(path, timers_g[chain[i]].name,
+                path_size - strlen(path) - 1);
+        if (i) strncat(path, "/", path_size - strlen(path) - 1);
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <mpi.h>
+
+#define MAX_TIMER_NAME_SIZE 128
+#define MAX_TIMER_PATH_SIZE 512
+
+/**
+ * Runtime timer registry. Timers are identified by name and registered the
+ * first time they are used, so backends can add their own (e.g.
+ * "hdf5.create_dataset" or "pdc.transfer_create") without touching a central
+ * list. A timer started while another one is running becomes its child,
+ * which gives every timer a path such as
+ * "write_all_chunks/write_chunk/hdf5.write". Entries are keyed on the
+ * parent and the name, so a name started under two parents is kept as two
+ * timers with their own paths.
+ *
+ * Every start/stop pair is kept as a sample. timers_reset() clears the
+ * samples but keeps the registrations so cached ids stay valid. The registry
+ * is not thread safe, only time from the main thread.
+ */
+typedef struct timer_entry_t {
+    char name[MAX_TIMER_NAME_SIZE];
+    // id timer_register returned for the name
+    int name_id;
+    // index of the enclosing entry, -1 for a root timer
+    int parent;
+    double start_time;
+    uint64_t count;
+    double total;
+    double *samples;
+    uint64_t samples_capacity;
+} timer_entry_t;
+
+// Returns the id of a name, the entries are created when it first runs
+int timer_register(const char *name);
+void timer_start(int id);
+void timer_stop(int id);
+// Adds a sample measured elsewhere, e.g. parsed from a server log
+void timer_record(const char *name, double seconds);
+void timers_reset(void);
+// Entries are indexed 0..timers_count()-1, independently of the name ids
+uint32_t timers_count(void);
+const timer_entry_t *timer_get(int id);
+// Writes the "/" separated names from the root timer down to entry id
+void timer_path(int id, char *path, uint32_t path_size);
+
+// Start the timer for a name, the id lookup is cached per call site
+#define START_TIMER(name)                                                      \
+    do {                                                                       \
+        static int __timer_id = -1;                                            \
+        if (__timer_id < 0) __timer_id = timer_register(name);                 \
+        timer_start(__timer_id);                                               \
+    } while (0)
+
+// Stop the timer and record the elapsed time as a sample
+#define STOP_TIMER(name)                                                       \
+    do {                                                                       \
+        static int __timer_id = -1;                                            \
+        if (__timer_id < 0) __timer_id = timer_register(name);                 \
+        timer_stop(__timer_id);                                                \
+    } while (0)
+
+#endif
@@ -1,3 +1,5 @@
+#define _XOPEN_SOURCE 500
+#include <ftw.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
@@ -22,3 +24,17 @@ char *random_string(uint32_t length) {
     buffer[length] = '\0';
     return buffer;
 }
+
+static uint64_t dir_size_total_g = 0;
+
+static int dir_size_visit(const char *path, const struct stat *sb, int type,
+                          struct FTW *ftwbuf) {
+    if (type == FTW_F) dir_size_total_g += (uint64_t) sb->st_size;
+    return 0;
+}
+
+uint64_t dir_size_bytes(const char *path) {
+    dir_size_total_g = 0;
+    if (nftw(path, dir_size_visit, 16, FTW_PHYS) != 0) return 0;
+    return dir_size_total_g;
+}
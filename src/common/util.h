@@ -4,5 +4,10 @@
 #include <stdint.h>
 
 char *random_string(uint32_t length);
+/**
+ * Sums the size of every regular file below path, symlinks are not
+ * followed. Returns 0 if path cannot be walked.
+ */
+uint64_t dir_size_bytes(const char *path);
 
 #endif
\ No newline at end of file
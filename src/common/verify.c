@@ -0,0 +1,124 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mpi.h>
+
+#include "verify.h"
+#include "datagen.h"
+#include "log.h"
+
+// Independent hash lanes, element i feeds lane i % VERIFY_LANES
+#define VERIFY_LANES 8
+#define VERIFY_PRIME 0x9E3779B97F4A7C15ULL
+
+static uint64_t fold64(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+uint64_t verify_chunk_checksum(const double *buffer, uint64_t num_elements) {
+    uint64_t lanes[VERIFY_LANES];
+    for (int l = 0; l < VERIFY_LANES; l++) lanes[l] = VERIFY_PRIME + l;
+
+    const uint64_t *bits = (const uint64_t *) buffer;
+    const uint64_t full = num_elements - num_elements % VERIFY_LANES;
+    for (uint64_t i = 0; i < full; i += VERIFY_LANES) {
+#pragma omp simd
+        for (int l = 0; l < VERIFY_LANES; l++) {
+            uint64_t h = (lanes[l] ^ bits[i + l]) * VERIFY_PRIME;
+            lanes[l] = h ^ (h >> 32);
+        }
+    }
+    for (uint64_t i = full; i < num_elements; i++) {
+        uint64_t h = (lanes[i % VERIFY_LANES] ^ bits[i]) * VERIFY_PRIME;
+        lanes[i % VERIFY_LANES] = h ^ (h >> 32);
+    }
+
+    uint64_t res = num_elements;
+    for (int l = 0; l < VERIFY_LANES; l++) res = fold64(res ^ lanes[l]);
+    return res;
+}
+
+void verify_compute_checksums(config_t *config, const double *buffer,
+                              uint64_t *checksums) {
+    const uint64_t chunk_elements = config->layout.chunk_elements;
+#pragma omp parallel for schedule(dynamic)
+    for (uint64_t chunk = 0; chunk < config->chunks_per_rank; chunk++)
+        checksums[chunk] = verify_chunk_checksum(
+            &buffer[chunk * chunk_elements], chunk_elements);
+}
+
+bool verify_full(config_t *config, config_workload_t *config_workload,
+                 const double *read_buf, double tolerance, double *max_error,
+                 double *rmse) {
+    const uint64_t chunk_elements = config->layout.chunk_elements;
+    double *expected = (double *) malloc(chunk_elements * sizeof(double));
+    bool valid = true;
+    uint64_t num_compared = 0;
+    double sum_sq = 0.0;
+
+    *max_error = 0.0;
+    for (uint64_t chunk = 0; chunk < config->chunks_per_rank && valid;
+         chunk++) {
+        // generation is threaded internally
+        datagen_fill_chunk(config, config_workload, chunk, expected);
+
+        const double *actual = &read_buf[chunk * chunk_elements];
+        double max_diff = 0.0, max_value = 0.0;
+        uint64_t non_finite = 0;
+#pragma omp parallel for simd reduction(max : max_diff, max_value) \
+    reduction(+ : sum_sq, non_finite)
+        for (uint64_t i = 0; i < chunk_elements; i++) {
+            double diff = fabs(actual[i] - expected[i]);
+            non_finite += !isfinite(actual[i]);
+            max_diff = fmax(max_diff, diff);
+            max_value = fmax(max_value, fabs(expected[i]));
+            sum_sq += diff * diff;
+        }
+        num_compared += chunk_elements;
+        *max_error = fmax(*max_error, max_diff);
+
+        // values in [-max_value, max_value] cannot be off by more than that
+        if (non_finite) {
+            PRINT_ERROR("Invalid data read in chunk %lu (%lu non-finite "
+                        "values)\n",
+                        chunk, non_finite);
+            valid = false;
+        } else if (!(max_diff <= tolerance) ||
+                   !(max_diff <= 2.0 * max_value)) {
+            PRINT_ERROR("Invalid data read in chunk %lu (diff = %g)\n", chunk,
+                        max_diff);
+            valid = false;
+        }
+    }
+
+    *rmse = num_compared ? sqrt(sum_sq / num_compared) : 0.0;
+    free(expected);
+    return valid;
+}
+
+bool verify_checksums(config_t *config, const double *read_buf,
+                      const uint64_t *expected) {
+    const uint64_t chunk_elements = config->layout.chunk_elements;
+    bool valid = true;
+
+#pragma omp parallel for schedule(dynamic)
+    for (uint64_t chunk = 0; chunk < config->chunks_per_rank; chunk++) {
+        bool still_valid;
+#pragma omp atomic read
+        still_valid = valid;
+        if (!still_valid) continue;
+
+        uint64_t actual = verify_chunk_checksum(
+            &read_buf[chunk * chunk_elements], chunk_elements);
+        if (actual != expected[chunk]) {
+            PRINT_ERROR("Checksum mismatch in chunk %lu (%016lx != %016lx)\n",
+                        chunk, actual, expected[chunk]);
+#pragma omp atomic write
+            valid = false;
+        }
+    }
+
+    return valid;
+}
@@ -0,0 +1,51 @@
+#ifndef VERIFY_H
+#define VERIFY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+// Allow small difference due to rounding
+#define VERIFY_TOLERANCE 1e-9
+
+/**
+ * Read verification. "full" regenerates every chunk from the workload's
+ * generator and compares element-wise, "checksum" compares a hash of each
+ * chunk against the one the write workload stored next to the dataset and
+ * "none" skips verification entirely.
+ */
+
+/**
+ * Hash of one chunk. Depends only on the bit patterns of the values, not on
+ * the number of threads, so write and read side always agree.
+ */
+uint64_t verify_chunk_checksum(const double *buffer, uint64_t num_elements);
+
+/**
+ * Hashes each of the rank's chunks_per_rank chunks stored back to back in
+ * buffer into checksums.
+ */
+void verify_compute_checksums(config_t *config, const double *buffer,
+                              uint64_t *checksums);
+
+/**
+ * Regenerates each chunk and compares it with read_buf. Stops at the first
+ * chunk with a non-finite value or an absolute error above tolerance or
+ * above the chunk's value range, twice its largest magnitude, which bounds
+ * even lossy modes without a tolerance of their own. Returns true if all
+ * chunks passed. The largest absolute error and the root mean square error
+ * over the compared chunks are returned in max_error and rmse.
+ */
+bool verify_full(config_t *config, config_workload_t *config_workload,
+                 const double *read_buf, double tolerance, double *max_error,
+                 double *rmse);
+
+/**
+ * Hashes each chunk of read_buf and compares it with expected. Stops at the
+ * first chunk that differs. Returns true if all chunks matched.
+ */
+bool verify_checksums(config_t *config, const double *read_buf,
+                      const uint64_t *expected);
+
+#endif
@@ -11,104 +11,394 @@
 #include "exec_io_impl.h"
 #include "common/log.h"
 #include "common/config.h"
+#include "common/datagen.h"
+#include "common/verify.h"
+
+/**
+ * Fills one chunk worth of write data from the workload's generator.
+ */
+static void fill_chunk(config_t *config, config_workload_t *config_workload,
+                       uint64_t chunk, double *buffer) {
+    START_TIMER("fill_chunk");
+    datagen_fill_chunk(config, config_workload, chunk, buffer);
+    STOP_TIMER("fill_chunk");
+}
+
+/**
+ * Largest absolute error a read may show. ZFP's accuracy mode bounds the
+ * error by its tolerance. Rate and precision modes give no absolute bound,
+ * their error is reported and only checked against the data's value range
+ * by verify_full.
+ */
+static double verify_tolerance(config_t *config) {
+    if (!strcmp(config->zfp.mode, "accuracy")) return config->zfp.param;
+    if (config_zfp_is_lossy(config)) return INFINITY;
+    return VERIFY_TOLERANCE;
+}
+
+/**
+ * Asks the backend how many bytes the dataset occupies on storage so the
+ * results can report the compression ratio and physical bandwidth.
+ */
+static void record_storage_size(io_impl_funcs_t io_impl_funcs,
+                                config_t *config,
+                                config_workload_t *config_workload) {
+    config->stored_bytes = 0;
+    if (!io_impl_funcs.get_storage_size) return;
+
+    PRINT_RANK0("Calling get_storage_size on impl\n");
+    config->stored_bytes =
+        io_impl_funcs.get_storage_size(config, config_workload);
+    PRINT_RANK0("Dataset stores %lu of %lu bytes\n", config->stored_bytes,
+                config->total_bytes);
+}
+
+/**
+ * Writes the chunks one write_chunk call at a time.
+ */
+static void exec_write_sync(io_impl_funcs_t io_impl_funcs, config_t *config,
+                            config_workload_t *config_workload,
+                            double *write_buffer) {
+    uint64_t chunk_elements = config->layout.chunk_elements;
+
+    PRINT_RANK0("Starting write\n");
+
+    START_TIMER("write_all_chunks");
+    MPI_Barrier(config->comm);
+    for (config->cur_chunk = 0; config->cur_chunk < config->chunks_per_rank;
+         config->cur_chunk++) {
+        PRINT_RANK0("Starting chunk write %lu\n", config->cur_chunk);
+        START_TIMER("write_chunk");
+        PRINT_RANK0("Calling write_chunk on impl\n");
+        io_impl_funcs.write_chunk(
+            config, config_workload,
+            &(write_buffer[chunk_elements * config->cur_chunk]));
+        STOP_TIMER("write_chunk");
+        PRINT_RANK0("Finished chunk write %lu\n", config->cur_chunk);
+    }
+    PRINT_RANK0("Calling write flush on impl\n");
+    START_TIMER("write_flush");
+    io_impl_funcs.flush(config, config_workload);
+    STOP_TIMER("write_flush");
+    MPI_Barrier(config->comm);
+    STOP_TIMER("write_all_chunks");
+}
+
+/**
+ * Reads the chunks one read_chunk call at a time into their slice of
+ * read_buf.
+ */
+static void exec_read_sync(io_impl_funcs_t io_impl_funcs, config_t *config,
+                           config_workload_t *config_workload,
+                           double *read_buf) {
+    uint64_t chunk_elements = config->layout.chunk_elements;
+
+    START_TIMER("read_all_chunks");
+    MPI_Barrier(config->comm);
+    for (config->cur_chunk = 0; config->cur_chunk < config->chunks_per_rank;
+         config->cur_chunk++) {
+        PRINT_RANK0("Starting chunk read %lu\n", config->cur_chunk);
+        START_TIMER("read_chunk");
+        PRINT_RANK0("Calling read_chunk on impl\n");
+        io_impl_funcs.read_chunk(
+            config, config_workload,
+            &(read_buf[chunk_elements * config->cur_chunk]));
+        STOP_TIMER("read_chunk");
+        PRINT_RANK0("Finished chunk read %lu\n", config->cur_chunk);
+    }
+    PRINT_RANK0("Calling read flush on impl\n");
+    START_TIMER("read_flush");
+    io_impl_funcs.flush(config, config_workload);
+    STOP_TIMER("read_flush");
+    MPI_Barrier(config->comm);
+    STOP_TIMER("read_all_chunks");
+}
+
+/**
+ * Writes every chunk keeping up to pipeline_depth of them in flight. Each
+ * slot of the ring is refilled only after the chunk that last used it has
+ * completed, so generating chunk k+1 overlaps the backend working on chunk k.
+ */
+static void exec_write_pipelined(io_impl_funcs_t io_impl_funcs,
+                                 config_t *config,
+                                 config_workload_t *config_workload,
+                                 uint64_t *checksums) {
+    uint32_t depth = config_workload->pipeline_depth;
+    uint64_t chunk_elements = config->layout.chunk_elements;
+    double *slots = (double *) malloc(chunk_elements * sizeof(double) * depth);
+    uint32_t in_flight = 0;
+
+    PRINT_RANK0("Starting pipelined write with depth %u\n", depth);
+
+    START_TIMER("write_all_chunks");
+    MPI_Barrier(config->comm);
+    for (config->cur_chunk = 0; config->cur_chunk < config->chunks_per_rank;
+         config->cur_chunk++) {
+        if (in_flight == depth) {
+            START_TIMER("write_complete");
+            io_impl_funcs.complete_chunk(config, config_workload);
+            STOP_TIMER("write_complete");
+            in_flight--;
+        }
+
+        double *slot = &slots[(config->cur_chunk % depth) * chunk_elements];
+        fill_chunk(config, config_workload, config->cur_chunk, slot);
+        if (checksums) {
+            START_TIMER("checksum");
+            checksums[config->cur_chunk] =
+                verify_chunk_checksum(slot, chunk_elements);
+            STOP_TIMER("checksum");
+        }
+
+        START_TIMER("write_chunk");
+        io_impl_funcs.submit_write_chunk(config, config_workload, slot);
+        STOP_TIMER("write_chunk");
+        in_flight++;
+    }
+    while (in_flight > 0) {
+        START_TIMER("write_complete");
+        io_impl_funcs.complete_chunk(config, config_workload);
+        STOP_TIMER("write_complete");
+        in_flight--;
+    }
+    PRINT_RANK0("Calling write flush on impl\n");
+    START_TIMER("write_flush");
+    io_impl_funcs.flush(config, config_workload);
+    STOP_TIMER("write_flush");
+    MPI_Barrier(config->comm);
+    STOP_TIMER("write_all_chunks");
+
+    free(slots);
+}
+
+/**
+ * Reads every chunk into its slice of read_buf keeping up to pipeline_depth
+ * of them in flight.
+ */
+static void exec_read_pipelined(io_impl_funcs_t io_impl_funcs,
+                                config_t *config,
+                                config_workload_t *config_workload,
+                                double *read_buf) {
+    uint32_t depth = config_workload->pipeline_depth;
+    uint64_t chunk_elements = config->layout.chunk_elements;
+    uint32_t in_flight = 0;
+
+    PRINT_RANK0("Starting pipelined read with depth %u\n", depth);
+
+    START_TIMER("read_all_chunks");
+    MPI_Barrier(config->comm);
+    for (config->cur_chunk = 0; config->cur_chunk < config->chunks_per_rank;
+         config->cur_chunk++) {
+        if (in_flight == depth) {
+            START_TIMER("read_complete");
+            io_impl_funcs.complete_chunk(config, config_workload);
+            STOP_TIMER("read_complete");
+            in_flight--;
+        }
+
+        START_TIMER("read_chunk");
+        io_impl_funcs.submit_read_chunk(
+            config, config_workload,
+            &(read_buf[chunk_elements * config->cur_chunk]));
+        STOP_TIMER("read_chunk");
+        in_flight++;
+    }
+    while (in_flight > 0) {
+        START_TIMER("read_complete");
+        io_impl_funcs.complete_chunk(config, config_workload);
+        STOP_TIMER("read_complete");
+        in_flight--;
+    }
+    PRINT_RANK0("Calling read flush on impl\n");
+    START_TIMER("read_flush");
+    io_impl_funcs.flush(config, config_workload);
+    STOP_TIMER("read_flush");
+    MPI_Barrier(config->comm);
+    STOP_TIMER("read_all_chunks");
+}
+
+/**
+ * Hands all of this rank's chunks to the backend in a single write_chunks
+ * call, so each rank issues one request per workload instead of one per
+ * chunk.
+ */
+static void exec_write_batched(io_impl_funcs_t io_impl_funcs,
+                               config_t *config,
+                               config_workload_t *config_workload,
+                               double *write_buffer) {
+    PRINT_RANK0("Starting batched write of %lu chunks\n",
+                config->chunks_per_rank);
+
+    START_TIMER("write_all_chunks");
+    MPI_Barrier(config->comm);
+    START_TIMER("write_chunks");
+    io_impl_funcs.write_chunks(config, config_workload, write_buffer);
+    STOP_TIMER("write_chunks");
+    PRINT_RANK0("Calling write flush on impl\n");
+    START_TIMER("write_flush");
+    io_impl_funcs.flush(config, config_workload);
+    STOP_TIMER("write_flush");
+    MPI_Barrier(config->comm);
+    STOP_TIMER("write_all_chunks");
+}
+
+/**
+ * Reads all of this rank's chunks into read_buf with a single read_chunks
+ * call.
+ */
+static void exec_read_batched(io_impl_funcs_t io_impl_funcs,
+                              config_t *config,
+                              config_workload_t *config_workload,
+                              double *read_buf) {
+    PRINT_RANK0("Starting batched read of %lu chunks\n",
+                config->chunks_per_rank);
+
+    START_TIMER("read_all_chunks");
+    MPI_Barrier(config->comm);
+    START_TIMER("read_chunks");
+    io_impl_funcs.read_chunks(config, config_workload, read_buf);
+    STOP_TIMER("read_chunks");
+    PRINT_RANK0("Calling read flush on impl\n");
+    START_TIMER("read_flush");
+    io_impl_funcs.flush(config, config_workload);
+    STOP_TIMER("read_flush");
+    MPI_Barrier(config->comm);
+    STOP_TIMER("read_all_chunks");
+}
 
 void exec_io_impl(io_impl_funcs_t io_impl_funcs, config_t *config,
                   config_workload_t *config_workload) {
+    config->backend_stats[0] = '\0';
+    config->server_timers[0] = '\0';
     io_impl_funcs.init(config, config_workload);
 
-    uint32_t chunk_bytes =
-        config->elements_per_dim * config->elements_per_dim * sizeof(double);
+    bool pipelined = !strcmp(config_workload->driver, "pipelined");
+    if (pipelined && (!io_impl_funcs.submit_write_chunk ||
+                      !io_impl_funcs.submit_read_chunk ||
+                      !io_impl_funcs.complete_chunk)) {
+        PRINT_ERROR(
+            "Implementation %s does not support the pipelined driver\n",
+            config_workload->implementation);
+        abort();
+    }
+    bool batched = !strcmp(config_workload->driver, "batched");
+    if (batched &&
+        (!io_impl_funcs.write_chunks || !io_impl_funcs.read_chunks)) {
+        PRINT_ERROR("Implementation %s does not support the batched driver\n",
+                    config_workload->implementation);
+        abort();
+    }
+
+    uint64_t chunk_elements = config->layout.chunk_elements;
+    uint64_t chunk_bytes = chunk_elements * sizeof(double);
+    bool use_checksums = !strcmp(config_workload->verify, "checksum");
+    if (use_checksums &&
+        (!io_impl_funcs.store_checksums || !io_impl_funcs.load_checksums)) {
+        PRINT_ERROR("Implementation %s does not support checksum verify\n",
+                    config_workload->implementation);
+        abort();
+    }
 
     if (!strcmp(config_workload->io_type, "write")) {
         PRINT_RANK0("Calling create_dataset on impl\n");
+        START_TIMER("create_dataset");
         io_impl_funcs.create_dataset(config, config_workload);
+        STOP_TIMER("create_dataset");
+
+        uint64_t *checksums =
+            use_checksums ? (uint64_t *) malloc(config->chunks_per_rank *
+                                                sizeof(uint64_t))
+                          : NULL;
+
+        if (pipelined) {
+            for (uint32_t i = 0; i < config_workload->iterations; i++)
+                exec_write_pipelined(io_impl_funcs, config, config_workload,
+                                     checksums);
+        } else {
+            // Generate every chunk up front so generation is not timed
+            double *write_buffer =
+                (double *) malloc(chunk_bytes * config->chunks_per_rank);
+            for (uint64_t chunk = 0; chunk < config->chunks_per_rank; chunk++)
+                fill_chunk(config, config_workload, chunk,
+                           &(write_buffer[chunk_elements * chunk]));
+            if (checksums) {
+                START_TIMER("checksum");
+                verify_compute_checksums(config, write_buffer, checksums);
+                STOP_TIMER("checksum");
+            }
 
-        // Allocate write buffer
-        double *write_buffer = (double *) malloc(chunk_bytes);
-        // Seed RNG
-        srand(42);
-        for (uint32_t i = 0; i < config->elements_per_dim; i++) {
-            for (uint32_t j = 0; j < config->elements_per_dim; j++) {
-                write_buffer[i * config->elements_per_dim + j] =
-                    (double) rand() + ((double) rand() / (double) RAND_MAX);
+            // every iteration rewrites the same chunks from the same buffer
+            for (uint32_t i = 0; i < config_workload->iterations; i++) {
+                if (batched)
+                    exec_write_batched(io_impl_funcs, config, config_workload,
+                                       write_buffer);
+                else
+                    exec_write_sync(io_impl_funcs, config, config_workload,
+                                    write_buffer);
             }
+
+            free(write_buffer);
         }
+        record_storage_size(io_impl_funcs, config, config_workload);
 
-        PRINT_RANK0("Starting write\n");
-
-        START_TIMER(WRITE_ALL_CHUNKS);
-        MPI_Barrier(MPI_COMM_WORLD);
-        for (config->cur_chunk = 0; config->cur_chunk < config->chunks_per_rank;
-             config->cur_chunk++) {
-            PRINT_RANK0("Starting chunk write %lu\n", config->cur_chunk);
-            START_TIMER(WRITE_CHUNK);
-            PRINT_RANK0("Calling write_chunk on impl\n");
-            io_impl_funcs.write_chunk(config, config_workload, write_buffer);
-            STOP_TIMER(WRITE_CHUNK);
-            PRINT_RANK0("Finished chunk write %lu\n", config->cur_chunk);
+        if (checksums) {
+            PRINT_RANK0("Calling store_checksums on impl\n");
+            io_impl_funcs.store_checksums(config, config_workload, checksums);
+            free(checksums);
         }
-        PRINT_RANK0("Calling write flush on impl\n");
-        START_TIMER(WRITE_FLUSH);
-        io_impl_funcs.flush(config, config_workload);
-        STOP_TIMER(WRITE_FLUSH);
-        MPI_Barrier(MPI_COMM_WORLD);
-        STOP_TIMER(WRITE_ALL_CHUNKS);
-
-        // close dataset
-        free(write_buffer);
     } else if ((!strcmp(config_workload->io_type, "read"))) {
         PRINT_RANK0("Calling open_dataset on impl\n");
+        START_TIMER("open_dataset");
         io_impl_funcs.open_dataset(config, config_workload);
+        STOP_TIMER("open_dataset");
 
         // Allocate read buffer
         double *read_buf =
             (double *) calloc(1, chunk_bytes * config->chunks_per_rank);
 
-        START_TIMER(READ_ALL_CHUNKS);
-        MPI_Barrier(MPI_COMM_WORLD);
-        for (config->cur_chunk = 0; config->cur_chunk < config->chunks_per_rank;
-             config->cur_chunk++) {
-            PRINT_RANK0("Starting chunk read %lu\n", config->cur_chunk);
-            START_TIMER(READ_CHUNK);
-            PRINT_RANK0("Calling read_chunk on impl\n");
-            io_impl_funcs.read_chunk(
-                config, config_workload,
-                &(read_buf[config->elements_per_dim * config->elements_per_dim *
-                           config->cur_chunk]));
-            STOP_TIMER(READ_CHUNK);
-            PRINT_RANK0("Finished chunk read %lu\n", config->cur_chunk);
-        }
-        PRINT_RANK0("Calling read flush on impl\n");
-        START_TIMER(READ_FLUSH);
-        io_impl_funcs.flush(config, config_workload);
-        STOP_TIMER(READ_FLUSH);
-        MPI_Barrier(MPI_COMM_WORLD);
-        STOP_TIMER(READ_ALL_CHUNKS);
-
-        for (config->cur_chunk = 0; config->cur_chunk < config->chunks_per_rank;
-             config->cur_chunk++) {
-            srand(42);
-            for (uint32_t i = 0; i < config->elements_per_dim; i++) {
-                for (uint32_t j = 0; j < config->elements_per_dim; j++) {
-                    double ran =
-                        (double) rand() + ((double) rand() / (double) RAND_MAX);
-                    double read_val =
-                        read_buf[(config->cur_chunk * config->elements_per_dim *
-                                  config->elements_per_dim) +
-                                 (i * config->elements_per_dim + j)];
-
-                    // Allow small difference due to rounding
-                    double diff = fabs(read_val - ran);
-                    const double tolerance = 1e-9;
-
-                    if (diff > tolerance) {
-                        PRINT_ERROR("Invalid data read (diff = %g)\n", diff);
-                        abort();
-                    }
-                }
+        for (uint32_t i = 0; i < config_workload->iterations; i++) {
+            if (pipelined) {
+                exec_read_pipelined(io_impl_funcs, config, config_workload,
+                                    read_buf);
+            } else if (batched) {
+                exec_read_batched(io_impl_funcs, config, config_workload,
+                                  read_buf);
+            } else {
+                exec_read_sync(io_impl_funcs, config, config_workload,
+                               read_buf);
             }
         }
-        PRINT_RANK0("Data read was valid :)\n");
+        record_storage_size(io_impl_funcs, config, config_workload);
+
+        bool valid = true;
+        START_TIMER("verify");
+        if (!strcmp(config_workload->verify, "full")) {
+            double max_error, rmse, global_max_error, sum_sq;
+            valid = verify_full(config, config_workload, read_buf,
+                                verify_tolerance(config), &max_error, &rmse);
+
+            rmse *= rmse;
+            MPI_Allreduce(&max_error, &global_max_error, 1, MPI_DOUBLE,
+                          MPI_MAX, config->comm);
+            MPI_Allreduce(&rmse, &sum_sq, 1, MPI_DOUBLE, MPI_SUM, config->comm);
+            if (config_zfp_is_lossy(config))
+                PRINT_RANK0("ZFP %s %g: max abs error %g, rmse %g\n",
+                            config->zfp.mode, config->zfp.param,
+                            global_max_error,
+                            sqrt(sum_sq / config->num_ranks));
+        } else if (use_checksums) {
+            uint64_t *expected =
+                (uint64_t *) malloc(config->chunks_per_rank * sizeof(uint64_t));
+            PRINT_RANK0("Calling load_checksums on impl\n");
+            io_impl_funcs.load_checksums(config, config_workload, expected);
+            valid = verify_checksums(config, read_buf, expected);
+            free(expected);
+        }
+        STOP_TIMER("verify");
+
+        if (!valid) abort();
+        if (strcmp(config_workload->verify, "none"))
+            PRINT_RANK0("Data read was valid :)\n");
         free(read_buf);
     } else {
         PRINT_ERROR("Invalid io type: %s\n", config_workload->io_type);
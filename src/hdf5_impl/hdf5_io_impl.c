@@ -2,12 +2,17 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <math.h>
 #include <unistd.h>
+#include <omp.h>
 
 #include "hdf5_io_impl.h"
 #include "../common/util.h"
 #include "../common/common.h"
 #include "../common/config.h"
+#include "../common/layout.h"
+#include "zfp_pool.h"
+#include "mpio_count.h"
 
 hid_t dcpl_g = -1;
 hid_t dset_g = -1;
@@ -17,6 +22,7 @@ hid_t space_g = -1;
 hid_t fapl_g = -1;
 
 #define DATASET_NAME "dataset"
+#define CHECKSUM_DATASET_NAME "chunk_checksums"
 #define OUTPUT_FILENAME "output.h5"
 
 #define MAX_NAME_SIZE 255
@@ -33,77 +39,401 @@ void hdf5_io_deinit(config_t *config, config_workload_t *config_workload) {
     H5_ASSERT(H5close());
 }
 
+/**
+ * Subfiling stripes the file over subfiles, each served by an I/O
+ * concentrator, instead of all ranks sharing one file.
+ */
+static void hdf5_io_set_subfiling(config_t *config, const config_hdf5_t *hdf5,
+                                  hid_t fapl, MPI_Info info) {
+#ifdef H5_HAVE_SUBFILING_VFD
+    // the concentrator count is only read from the environment
+    if (hdf5->ioc_per_node) {
+        char value[32];
+        snprintf(value, sizeof(value), "%u", hdf5->ioc_per_node);
+        setenv(H5FD_SUBFILING_IOC_PER_NODE, value, 1);
+    }
+
+    // returns the defaults while the fapl has no subfiling config yet
+    H5FD_subfiling_config_t subfiling;
+    H5_ASSERT(H5Pget_fapl_subfiling(fapl, &subfiling));
+    if (hdf5->stripe_size) subfiling.shared_cfg.stripe_size = hdf5->stripe_size;
+
+    H5_ASSERT(H5Pset_mpi_params(fapl, config->comm, info));
+    H5_ASSERT(H5Pset_fapl_subfiling(fapl, &subfiling));
+#else
+    PRINT_ERROR("HDF5 was built without the subfiling VFD\n");
+    abort();
+#endif
+}
+
+/**
+ * The core driver gives every rank a file of its own in memory, which keeps
+ * the filter and HDF5 code path of the shared file runs without their
+ * storage and MPI-IO cost.
+ */
+static bool hdf5_io_is_core(config_workload_t *config_workload) {
+    return !strcmp(config_workload->hdf5.file_driver, "core");
+}
+
+static void hdf5_io_filename(config_t *config,
+                             config_workload_t *config_workload,
+                             char *filename) {
+    if (hdf5_io_is_core(config_workload))
+        snprintf(filename, MAX_NAME_SIZE, "%s.%d", OUTPUT_FILENAME,
+                 config->my_rank);
+    else
+        snprintf(filename, MAX_NAME_SIZE, "%s", OUTPUT_FILENAME);
+}
+
+/**
+ * File access property list for the workload's file driver.
+ */
+static hid_t hdf5_io_create_fapl(config_t *config,
+                                 config_workload_t *config_workload) {
+    const config_hdf5_t *hdf5 = &config_workload->hdf5;
+    hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+    H5_ASSERT(fapl);
+
+    // HDF5 keeps its own copy of the hints
+    MPI_Info info = MPI_INFO_NULL;
+    if (hdf5->num_mpi_hints) {
+        MPI_Info_create(&info);
+        for (uint32_t i = 0; i < hdf5->num_mpi_hints; i++) {
+            PRINT_RANK0("MPI_Info hint %s=%s\n", hdf5->mpi_hints[i][0],
+                        hdf5->mpi_hints[i][1]);
+            MPI_Info_set(info, hdf5->mpi_hints[i][0], hdf5->mpi_hints[i][1]);
+        }
+    }
+
+    if (!strcmp(hdf5->file_driver, "subfiling"))
+        hdf5_io_set_subfiling(config, hdf5, fapl, info);
+    else if (hdf5_io_is_core(config_workload)) {
+        // grow the image by the rank's uncompressed data at once
+        size_t increment = config->chunks_per_rank *
+                           config->layout.chunk_elements * sizeof(double);
+        H5_ASSERT(H5Pset_fapl_core(fapl, increment, hdf5->backing_store));
+    } else
+        H5_ASSERT(H5Pset_fapl_mpio(fapl, config->comm, info));
+    if (info != MPI_INFO_NULL) MPI_Info_free(&info);
+
+    // keeps compressed chunks from straddling file system stripes
+    if (hdf5->alignment)
+        H5_ASSERT(H5Pset_alignment(fapl, hdf5->alignment_threshold,
+                                   hdf5->alignment));
+
+    if (hdf5->mdc_initial_size || hdf5->mdc_max_size) {
+        H5AC_cache_config_t mdc;
+        mdc.version = H5AC__CURR_CACHE_CONFIG_VERSION;
+        H5_ASSERT(H5Pget_mdc_config(fapl, &mdc));
+        if (hdf5->mdc_initial_size) {
+            mdc.set_initial_size = true;
+            mdc.initial_size = hdf5->mdc_initial_size;
+        }
+        if (hdf5->mdc_max_size) mdc.max_size = hdf5->mdc_max_size;
+
+        // the cache needs min_size <= initial_size <= max_size
+        if (mdc.initial_size > mdc.max_size) {
+            if (hdf5->mdc_max_size)
+                mdc.initial_size = mdc.max_size;
+            else
+                mdc.max_size = mdc.initial_size;
+        }
+        if (mdc.min_size > mdc.initial_size) mdc.min_size = mdc.initial_size;
+        H5_ASSERT(H5Pset_mdc_config(fapl, &mdc));
+    }
+
+    if (hdf5->coll_metadata_ops)
+        H5_ASSERT(H5Pset_all_coll_metadata_ops(fapl, true));
+    if (hdf5->coll_metadata_write)
+        H5_ASSERT(H5Pset_coll_metadata_write(fapl, true));
+
+    // the config only allows it on the core driver
+    if (hdf5->page_buffer_size)
+        H5_ASSERT(H5Pset_page_buffer_size(fapl, hdf5->page_buffer_size, 0, 0));
+    return fapl;
+}
+
+/**
+ * File creation property list with the workload's file space strategy.
+ * Paged aggregation packs metadata and raw data into separate pages, so
+ * small metadata writes no longer land between variable sized chunks.
+ */
+static hid_t hdf5_io_create_fcpl(config_workload_t *config_workload) {
+    const config_hdf5_t *hdf5 = &config_workload->hdf5;
+    hid_t fcpl = H5Pcreate(H5P_FILE_CREATE);
+    H5_ASSERT(fcpl);
+
+    if (!strcmp(hdf5->file_space_strategy, "page")) {
+        H5_ASSERT(H5Pset_file_space_strategy(fcpl, H5F_FSPACE_STRATEGY_PAGE,
+                                             false, 1));
+        if (hdf5->page_size)
+            H5_ASSERT(H5Pset_file_space_page_size(fcpl, hdf5->page_size));
+    }
+    return fcpl;
+}
+
+/**
+ * MPI-IO writes of the last flush, summed over the ranks, and the slowest
+ * rank's time in them. Parallel HDF5 writes chunks around the chunk cache
+ * when an MPI-IO file is open for writing, so what the flush writes is
+ * metadata.
+ */
+static mpio_count_t meta_writes_g = {0, 0, 0.0};
+
+static void hdf5_io_count_meta_writes(config_t *config,
+                                      const mpio_count_t *before) {
+    mpio_count_t after;
+    mpio_count_get(&after);
+    uint64_t writes[2] = {after.writes - before->writes,
+                          after.bytes - before->bytes};
+    double seconds = after.seconds - before->seconds;
+
+    uint64_t totals[2];
+    MPI_Allreduce(writes, totals, 2, MPI_UINT64_T, MPI_SUM, config->comm);
+    MPI_Allreduce(&seconds, &meta_writes_g.seconds, 1, MPI_DOUBLE, MPI_MAX,
+                  config->comm);
+    meta_writes_g.writes = totals[0];
+    meta_writes_g.bytes = totals[1];
+}
+
+/**
+ * Reports the file's size and free space, on the MPI-IO driver the
+ * metadata writes of the flush and, with a page buffer, its metadata page
+ * statistics in config->backend_stats. Free space shows how much the chunk
+ * allocations fragment the file.
+ */
+static void hdf5_io_record_file_stats(config_t *config,
+                                      config_workload_t *config_workload) {
+    hsize_t file_size;
+    H5F_info2_t info;
+    H5_ASSERT(H5Fget_filesize(file_g, &file_size));
+    H5_ASSERT(H5Fget_info2(file_g, &info));
+    hssize_t free_space = H5Fget_freespace(file_g);
+    H5_ASSERT(free_space);
+
+    size_t len = snprintf(config->backend_stats, MAX_CONFIG_STRING_SIZE,
+                          "file_size=%llu;free_space=%lld;"
+                          "free_space_meta=%llu",
+                          file_size, free_space, info.free.meta_size);
+
+    if (!strcmp(config_workload->hdf5.file_driver, "mpio") &&
+        len < MAX_CONFIG_STRING_SIZE)
+        len += snprintf(&config->backend_stats[len],
+                        MAX_CONFIG_STRING_SIZE - len,
+                        ";meta_writes=%lu;meta_write_bytes=%lu;"
+                        "meta_write_s=%f",
+                        meta_writes_g.writes, meta_writes_g.bytes,
+                        meta_writes_g.seconds);
+
+    if (!config_workload->hdf5.page_buffer_size ||
+        len >= MAX_CONFIG_STRING_SIZE)
+        return;
+
+    // index 0 counts metadata pages, 1 raw data pages
+    unsigned int accesses[2], hits[2], misses[2], evictions[2], bypasses[2];
+    H5_ASSERT(H5Fget_page_buffering_stats(file_g, accesses, hits, misses,
+                                          evictions, bypasses));
+    snprintf(&config->backend_stats[len], MAX_CONFIG_STRING_SIZE - len,
+             ";pb_meta_accesses=%u;pb_meta_misses=%u;pb_meta_evictions=%u;"
+             "pb_meta_bypasses=%u",
+             accesses[0], misses[0], evictions[0], bypasses[0]);
+}
+
+/**
+ * Dataset access property list with the workload's chunk cache. The default
+ * cache of 1 MiB is smaller than a typical chunk, which then bypasses it.
+ */
+static hid_t hdf5_io_create_dapl(config_workload_t *config_workload) {
+    const config_hdf5_t *hdf5 = &config_workload->hdf5;
+    hid_t dapl = H5Pcreate(H5P_DATASET_ACCESS);
+    H5_ASSERT(dapl);
+
+    if (hdf5->chunk_cache_bytes || hdf5->chunk_cache_slots ||
+        hdf5->chunk_cache_w0 >= 0.0)
+        H5_ASSERT(H5Pset_chunk_cache(
+            dapl,
+            hdf5->chunk_cache_slots ? hdf5->chunk_cache_slots
+                                    : H5D_CHUNK_CACHE_NSLOTS_DEFAULT,
+            hdf5->chunk_cache_bytes ? hdf5->chunk_cache_bytes
+                                    : H5D_CHUNK_CACHE_NBYTES_DEFAULT,
+            hdf5->chunk_cache_w0 >= 0.0 ? hdf5->chunk_cache_w0
+                                        : H5D_CHUNK_CACHE_W0_DEFAULT));
+    return dapl;
+}
+
+/**
+ * When chunk space is allocated and whether fill values are written to it.
+ * The MPI-IO driver forces early allocation of unfiltered datasets, so
+ * alloc_time only takes effect with a filter.
+ */
+static void hdf5_io_set_space_policy(config_workload_t *config_workload,
+                                     hid_t dcpl) {
+    const config_hdf5_t *hdf5 = &config_workload->hdf5;
+
+    if (!strcmp(hdf5->alloc_time, "early"))
+        H5_ASSERT(H5Pset_alloc_time(dcpl, H5D_ALLOC_TIME_EARLY));
+    else if (!strcmp(hdf5->alloc_time, "incr"))
+        H5_ASSERT(H5Pset_alloc_time(dcpl, H5D_ALLOC_TIME_INCR));
+    else if (!strcmp(hdf5->alloc_time, "late"))
+        H5_ASSERT(H5Pset_alloc_time(dcpl, H5D_ALLOC_TIME_LATE));
+
+    if (!strcmp(hdf5->fill_time, "alloc"))
+        H5_ASSERT(H5Pset_fill_time(dcpl, H5D_FILL_TIME_ALLOC));
+    else if (!strcmp(hdf5->fill_time, "ifset"))
+        H5_ASSERT(H5Pset_fill_time(dcpl, H5D_FILL_TIME_IFSET));
+    else if (!strcmp(hdf5->fill_time, "never"))
+        H5_ASSERT(H5Pset_fill_time(dcpl, H5D_FILL_TIME_NEVER));
+}
+
+/**
+ * Adds the ZFP filter in the current zfp mode to dcpl.
+ */
+static void hdf5_io_set_zfp_filter(config_t *config, hid_t dcpl) {
+    unsigned int cd_values[H5Z_ZFP_CD_NELMTS_MAX];
+    size_t cd_nelmts = H5Z_ZFP_CD_NELMTS_MAX;
+    if (!strcmp(config->zfp.mode, "rate"))
+        H5Pset_zfp_rate_cdata(config->zfp.param, cd_nelmts, cd_values);
+    else if (!strcmp(config->zfp.mode, "precision"))
+        H5Pset_zfp_precision_cdata((unsigned int) config->zfp.param,
+                                   cd_nelmts, cd_values);
+    else if (!strcmp(config->zfp.mode, "accuracy"))
+        H5Pset_zfp_accuracy_cdata(config->zfp.param, cd_nelmts, cd_values);
+    else
+        H5Pset_zfp_reversible_cdata(cd_nelmts, cd_values);
+    H5_ASSERT(H5Pset_filter(dcpl, H5Z_FILTER_ZFP, H5Z_FLAG_MANDATORY,
+                            cd_nelmts, cd_values));
+}
+
 void hdf5_io_create_dataset(config_t *config,
                             config_workload_t *config_workload) {
-    const hsize_t total_chunks = config->num_ranks * config->chunks_per_rank;
+    PRINT_RANK0("Using the %s file driver\n",
+                config_workload->hdf5.file_driver);
+    fapl_g = hdf5_io_create_fapl(config, config_workload);
 
-    fapl_g = H5Pcreate(H5P_FILE_ACCESS);
-    H5_ASSERT(H5Pset_fapl_mpio(fapl_g, MPI_COMM_WORLD, MPI_INFO_NULL));
+    hid_t fcpl = hdf5_io_create_fcpl(config_workload);
+    char filename[MAX_NAME_SIZE];
+    hdf5_io_filename(config, config_workload, filename);
 
-    file_g = H5Fcreate(OUTPUT_FILENAME, H5F_ACC_TRUNC, H5P_DEFAULT, fapl_g);
+    START_TIMER("hdf5.create_file");
+    file_g = H5Fcreate(filename, H5F_ACC_TRUNC, fcpl, fapl_g);
+    STOP_TIMER("hdf5.create_file");
     H5_ASSERT(file_g);
     H5Pclose(fapl_g);
+    H5_ASSERT(H5Pclose(fcpl));
 
-    hsize_t dims[2] = {total_chunks * config->elements_per_dim,
-                       config->elements_per_dim};
-    hsize_t chunk_dims[2] = {config->elements_per_dim,
-                             config->elements_per_dim};
+    const config_layout_t *layout = &config->layout;
+    hsize_t dims[MAX_CONFIG_DIMS], chunk_dims[MAX_CONFIG_DIMS];
+    for (uint32_t d = 0; d < layout->ndims; d++) {
+        dims[d] = layout->global_dims[d];
+        chunk_dims[d] = layout->chunk_dims[d];
+    }
 
-    space_g = H5Screate_simple(2, dims, NULL);
+    space_g = H5Screate_simple(layout->ndims, dims, NULL);
 
     dcpl_g = H5Pcreate(H5P_DATASET_CREATE);
     H5_ASSERT(dcpl_g);
-    H5_ASSERT(H5Pset_chunk(dcpl_g, 2, chunk_dims));
-
-    if (!strcmp(config_workload->io_filter, "zfp")) {
-        PRINT_RANK0("Enabling ZFP filter\n");
+    H5_ASSERT(H5Pset_chunk(dcpl_g, layout->ndims, chunk_dims));
 
-        // Enable compression
-        unsigned int cd_values[6];
-        size_t cd_nelmts = 6;
-        H5Pset_zfp_reversible_cdata(cd_nelmts, cd_values);
-        // Apply ZFP filter to dataset creation property list
-        herr_t status = H5Pset_filter(dcpl_g, H5Z_FILTER_ZFP,
-                                      H5Z_FLAG_MANDATORY, cd_nelmts, cd_values);
-        if (status < 0) { fprintf(stderr, "Error setting ZFP filter\n"); }
+    if (config_filter_is_zfp(config_workload)) {
+        PRINT_RANK0("Enabling ZFP filter in %s mode\n", config->zfp.mode);
+        hdf5_io_set_zfp_filter(config, dcpl_g);
     }
 
+    hid_t dapl = hdf5_io_create_dapl(config_workload);
+    hdf5_io_set_space_policy(config_workload, dcpl_g);
+
+    START_TIMER("hdf5.create_dataset");
     dset_g = H5Dcreate(file_g, DATASET_NAME, H5T_NATIVE_DOUBLE, space_g,
-                       H5P_DEFAULT, dcpl_g, H5P_DEFAULT);
+                       H5P_DEFAULT, dcpl_g, dapl);
+    STOP_TIMER("hdf5.create_dataset");
     H5_ASSERT(dset_g);
+    H5_ASSERT(H5Pclose(dapl));
     H5_ASSERT(H5Pclose(dcpl_g));
     H5_ASSERT(H5Sclose(space_g));
 }
 
-void hdf5_io_write_chunk(config_t *config, config_workload_t *config_workload,
-                         double *buffer) {
-    hsize_t offset[2] = {
-        (config->my_rank * config->chunks_per_rank + config->cur_chunk) *
-            config->elements_per_dim,
-        0};
-    hsize_t size[2] = {config->elements_per_dim, config->elements_per_dim};
-
-    filespace_g = H5Dget_space(dset_g);
-    H5_ASSERT(filespace_g);
-    H5_ASSERT(H5Sselect_hyperslab(filespace_g, H5S_SELECT_SET, offset, NULL,
-                                  size, NULL));
-
-    hid_t memspace = H5Screate_simple(2, size, NULL);
-    H5_ASSERT(memspace);
-
+/**
+ * Transfer property list for the current io participation.
+ */
+static hid_t hdf5_io_create_dxpl(config_t *config) {
     hid_t dxpl = H5Pcreate(H5P_DATASET_XFER);
     H5_ASSERT(dxpl);
 
     if (!strcmp(config->io_participation, "collective"))
         H5_ASSERT(H5Pset_dxpl_mpio(dxpl, H5FD_MPIO_COLLECTIVE));
-    else if (!strcmp(config->io_participation, "indepdendent"))
+    else if (!strcmp(config->io_participation, "independent"))
         H5_ASSERT(H5Pset_dxpl_mpio(dxpl, H5FD_MPIO_INDEPENDENT));
     else {
         PRINT_ERROR("Invalid io participation: %s\n", config->io_participation);
     }
+    return dxpl;
+}
+
+/**
+ * Selects the current chunk in the dataset and builds the matching memory
+ * space and transfer property list. Caller closes all three.
+ */
+static void hdf5_io_select_chunk(config_t *config, hid_t *filespace,
+                                 hid_t *memspace, hid_t *dxpl) {
+    START_TIMER("hdf5.select");
+    const config_layout_t *layout = &config->layout;
+    uint64_t chunk_offset[MAX_CONFIG_DIMS];
+    hsize_t offset[MAX_CONFIG_DIMS], size[MAX_CONFIG_DIMS];
+    layout_chunk_offset(config, config->cur_chunk, chunk_offset);
+    for (uint32_t d = 0; d < layout->ndims; d++) {
+        offset[d] = chunk_offset[d];
+        size[d] = layout->chunk_dims[d];
+    }
 
+    *filespace = H5Dget_space(dset_g);
+    H5_ASSERT(*filespace);
+    H5_ASSERT(H5Sselect_hyperslab(*filespace, H5S_SELECT_SET, offset, NULL,
+                                  size, NULL));
+
+    *memspace = H5Screate_simple(layout->ndims, size, NULL);
+    H5_ASSERT(*memspace);
+
+    *dxpl = hdf5_io_create_dxpl(config);
+    STOP_TIMER("hdf5.select");
+}
+
+/**
+ * Selects this rank's whole block of chunks as one hyperslab, which chunk 0
+ * starts. Caller closes all three.
+ */
+static void hdf5_io_select_rank_block(config_t *config, hid_t *filespace,
+                                      hid_t *memspace, hid_t *dxpl) {
+    START_TIMER("hdf5.select");
+    const config_layout_t *layout = &config->layout;
+    uint64_t block_offset[MAX_CONFIG_DIMS];
+    hsize_t offset[MAX_CONFIG_DIMS], size[MAX_CONFIG_DIMS];
+    layout_chunk_offset(config, 0, block_offset);
+    for (uint32_t d = 0; d < layout->ndims; d++) {
+        offset[d] = block_offset[d];
+        size[d] = layout->rank_chunks[d] * layout->chunk_dims[d];
+    }
+
+    *filespace = H5Dget_space(dset_g);
+    H5_ASSERT(*filespace);
+    H5_ASSERT(H5Sselect_hyperslab(*filespace, H5S_SELECT_SET, offset, NULL,
+                                  size, NULL));
+
+    *memspace = H5Screate_simple(layout->ndims, size, NULL);
+    H5_ASSERT(*memspace);
+
+    *dxpl = hdf5_io_create_dxpl(config);
+    STOP_TIMER("hdf5.select");
+}
+
+void hdf5_io_write_chunk(config_t *config, config_workload_t *config_workload,
+                         double *buffer) {
+    hid_t memspace, dxpl;
+    hdf5_io_select_chunk(config, &filespace_g, &memspace, &dxpl);
+
+    START_TIMER("hdf5.write");
     H5_ASSERT(H5Dwrite(dset_g, H5T_NATIVE_DOUBLE, memspace, filespace_g, dxpl,
                        buffer));
+    STOP_TIMER("hdf5.write");
 
     H5_ASSERT(H5Pclose(dxpl));
     H5_ASSERT(H5Sclose(memspace));
@@ -112,41 +442,223 @@ void hdf5_io_write_chunk(config_t *config, config_workload_t *config_workload,
 
 void hdf5_io_read_chunk(config_t *config, config_workload_t *config_workload,
                         double *buffer) {
-    hsize_t offset[2] = {
-        (config->my_rank * config->chunks_per_rank + config->cur_chunk) *
-            config->elements_per_dim,
-        0};
-    hsize_t size[2] = {config->elements_per_dim, config->elements_per_dim};
-
-    filespace_g = H5Dget_space(dset_g);
-    H5_ASSERT(filespace_g);
-    H5_ASSERT(H5Sselect_hyperslab(filespace_g, H5S_SELECT_SET, offset, NULL,
-                                  size, NULL));
+    hid_t memspace, dxpl;
+    hdf5_io_select_chunk(config, &filespace_g, &memspace, &dxpl);
 
-    hid_t memspace = H5Screate_simple(2, size, NULL);
-    H5_ASSERT(memspace);
+    START_TIMER("hdf5.read");
+    H5_ASSERT(H5Dread(dset_g, H5T_NATIVE_DOUBLE, memspace, filespace_g, dxpl,
+                      buffer));
+    STOP_TIMER("hdf5.read");
 
-    hid_t dxpl = H5Pcreate(H5P_DATASET_XFER);
-    H5_ASSERT(dxpl);
+    H5_ASSERT(H5Pclose(dxpl));
+    H5_ASSERT(H5Sclose(memspace));
+    H5_ASSERT(H5Sclose(filespace_g));
+}
 
-    if (!strcmp(config->io_participation, "collective"))
-        H5_ASSERT(H5Pset_dxpl_mpio(dxpl, H5FD_MPIO_COLLECTIVE));
-    else if (!strcmp(config->io_participation, "indepdendent"))
-        H5_ASSERT(H5Pset_dxpl_mpio(dxpl, H5FD_MPIO_INDEPENDENT));
-    else {
-        PRINT_ERROR("Invalid io participation: %s\n", config->io_participation);
+/**
+ * Batched mode writes the rank's block with a single H5Dwrite, so collective
+ * runs synchronize once per workload rather than once per chunk. When the
+ * rank has chunks along more than the first dimension the chunks are
+ * repacked into the block's row-major order first.
+ */
+void hdf5_io_write_chunks(config_t *config, config_workload_t *config_workload,
+                          double *buffer) {
+    hid_t memspace, dxpl;
+    hdf5_io_select_rank_block(config, &filespace_g, &memspace, &dxpl);
+
+    double *block = buffer;
+    if (!layout_rank_block_contiguous(config)) {
+        START_TIMER("hdf5.pack");
+        block = (double *) malloc(config->layout.chunk_elements *
+                                  config->chunks_per_rank * sizeof(double));
+        layout_copy_rank_block(config, buffer, block, true);
+        STOP_TIMER("hdf5.pack");
     }
 
+    START_TIMER("hdf5.write");
+    H5_ASSERT(H5Dwrite(dset_g, H5T_NATIVE_DOUBLE, memspace, filespace_g, dxpl,
+                       block));
+    STOP_TIMER("hdf5.write");
+
+    if (block != buffer) free(block);
+    H5_ASSERT(H5Pclose(dxpl));
+    H5_ASSERT(H5Sclose(memspace));
+    H5_ASSERT(H5Sclose(filespace_g));
+}
+
+void hdf5_io_read_chunks(config_t *config, config_workload_t *config_workload,
+                         double *buffer) {
+    hid_t memspace, dxpl;
+    hdf5_io_select_rank_block(config, &filespace_g, &memspace, &dxpl);
+
+    bool contiguous = layout_rank_block_contiguous(config);
+    double *block = buffer;
+    if (!contiguous)
+        block = (double *) malloc(config->layout.chunk_elements *
+                                  config->chunks_per_rank * sizeof(double));
+
+    START_TIMER("hdf5.read");
     H5_ASSERT(H5Dread(dset_g, H5T_NATIVE_DOUBLE, memspace, filespace_g, dxpl,
-                      buffer));
+                      block));
+    STOP_TIMER("hdf5.read");
+
+    if (!contiguous) {
+        START_TIMER("hdf5.unpack");
+        layout_copy_rank_block(config, buffer, block, false);
+        STOP_TIMER("hdf5.unpack");
+        free(block);
+    }
+    H5_ASSERT(H5Pclose(dxpl));
+    H5_ASSERT(H5Sclose(memspace));
+    H5_ASSERT(H5Sclose(filespace_g));
+}
+
+/**
+ * Pipelined mode keeps one event set per in-flight chunk in a ring so chunks
+ * can be retired in submission order. Without an async VOL connector the
+ * *_async calls complete before returning and H5ESwait is a no-op.
+ */
+static hid_t es_ring_g[MAX_CONFIG_PIPELINE_DEPTH];
+static uint32_t es_head_g = 0;
+static uint32_t es_count_g = 0;
+
+static hid_t hdf5_io_push_es(void) {
+    ASSERT(es_count_g < MAX_CONFIG_PIPELINE_DEPTH,
+           "Too many chunks in flight (%u)\n", es_count_g);
+    hid_t es = H5EScreate();
+    H5_ASSERT(es);
+    es_ring_g[(es_head_g + es_count_g) % MAX_CONFIG_PIPELINE_DEPTH] = es;
+    es_count_g++;
+    return es;
+}
+
+void hdf5_io_submit_write_chunk(config_t *config,
+                                config_workload_t *config_workload,
+                                double *buffer) {
+    hid_t memspace, dxpl;
+    hdf5_io_select_chunk(config, &filespace_g, &memspace, &dxpl);
+
+    hid_t es = hdf5_io_push_es();
+    H5_ASSERT(H5Dwrite_async(dset_g, H5T_NATIVE_DOUBLE, memspace, filespace_g,
+                             dxpl, buffer, es));
 
     H5_ASSERT(H5Pclose(dxpl));
     H5_ASSERT(H5Sclose(memspace));
     H5_ASSERT(H5Sclose(filespace_g));
 }
 
+void hdf5_io_submit_read_chunk(config_t *config,
+                               config_workload_t *config_workload,
+                               double *buffer) {
+    hid_t memspace, dxpl;
+    hdf5_io_select_chunk(config, &filespace_g, &memspace, &dxpl);
+
+    hid_t es = hdf5_io_push_es();
+    H5_ASSERT(H5Dread_async(dset_g, H5T_NATIVE_DOUBLE, memspace, filespace_g,
+                            dxpl, buffer, es));
+
+    H5_ASSERT(H5Pclose(dxpl));
+    H5_ASSERT(H5Sclose(memspace));
+    H5_ASSERT(H5Sclose(filespace_g));
+}
+
+void hdf5_io_complete_chunk(config_t *config,
+                            config_workload_t *config_workload) {
+    ASSERT(es_count_g > 0, "complete_chunk called with nothing in flight\n");
+    hid_t es = es_ring_g[es_head_g];
+    es_head_g = (es_head_g + 1) % MAX_CONFIG_PIPELINE_DEPTH;
+    es_count_g--;
+
+    size_t num_in_progress;
+    hbool_t op_failed;
+    START_TIMER("hdf5.es_wait");
+    H5_ASSERT(H5ESwait(es, H5ES_WAIT_FOREVER, &num_in_progress, &op_failed));
+    STOP_TIMER("hdf5.es_wait");
+    ASSERT(!op_failed, "Asynchronous chunk operation failed\n");
+    H5_ASSERT(H5ESclose(es));
+}
+
+/**
+ * Checksums live in a small 1D dataset next to the data, one entry per chunk.
+ * An attribute would be simpler but compact attribute storage is capped at
+ * 64 KiB, which 8192 ranks with a few chunks each already exceed.
+ */
+static void hdf5_io_select_checksums(config_t *config, hid_t dset,
+                                     hid_t *filespace, hid_t *memspace) {
+    hsize_t offset[1] = {config->my_rank * config->chunks_per_rank};
+    hsize_t size[1] = {config->chunks_per_rank};
+
+    *filespace = H5Dget_space(dset);
+    H5_ASSERT(*filespace);
+    H5_ASSERT(H5Sselect_hyperslab(*filespace, H5S_SELECT_SET, offset, NULL,
+                                  size, NULL));
+    *memspace = H5Screate_simple(1, size, NULL);
+    H5_ASSERT(*memspace);
+}
+
+void hdf5_io_store_checksums(config_t *config,
+                             config_workload_t *config_workload,
+                             uint64_t *checksums) {
+    hsize_t dims[1] = {config->num_ranks * config->chunks_per_rank};
+    hid_t space = H5Screate_simple(1, dims, NULL);
+    H5_ASSERT(space);
+    hid_t dset = H5Dcreate(file_g, CHECKSUM_DATASET_NAME, H5T_NATIVE_UINT64,
+                           space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    H5_ASSERT(dset);
+    H5_ASSERT(H5Sclose(space));
+
+    hid_t filespace, memspace;
+    hdf5_io_select_checksums(config, dset, &filespace, &memspace);
+    H5_ASSERT(H5Dwrite(dset, H5T_NATIVE_UINT64, memspace, filespace,
+                       H5P_DEFAULT, checksums));
+
+    H5_ASSERT(H5Sclose(memspace));
+    H5_ASSERT(H5Sclose(filespace));
+    H5_ASSERT(H5Dclose(dset));
+}
+
+void hdf5_io_load_checksums(config_t *config,
+                            config_workload_t *config_workload,
+                            uint64_t *checksums) {
+    hid_t dset = H5Dopen(file_g, CHECKSUM_DATASET_NAME, H5P_DEFAULT);
+    if (dset < 0) {
+        PRINT_ERROR("No %s dataset, was the write run with checksums?\n",
+                    CHECKSUM_DATASET_NAME);
+        abort();
+    }
+
+    hid_t filespace, memspace;
+    hdf5_io_select_checksums(config, dset, &filespace, &memspace);
+    H5_ASSERT(H5Dread(dset, H5T_NATIVE_UINT64, memspace, filespace,
+                      H5P_DEFAULT, checksums));
+
+    H5_ASSERT(H5Sclose(memspace));
+    H5_ASSERT(H5Sclose(filespace));
+    H5_ASSERT(H5Dclose(dset));
+}
+
 void hdf5_io_flush(config_t *config, config_workload_t *config_workload) {
+    mpio_count_t before;
+    mpio_count_get(&before);
+    START_TIMER("hdf5.flush");
     H5_ASSERT(H5Fflush(file_g, H5F_SCOPE_GLOBAL));
+    STOP_TIMER("hdf5.flush");
+    hdf5_io_count_meta_writes(config, &before);
+    hdf5_io_record_file_stats(config, config_workload);
+}
+
+/**
+ * Allocated size of the dataset's chunks, which after the ZFP filter is the
+ * compressed size. Metadata and the checksum dataset are not included. Core
+ * files only hold their rank's chunks and are summed over the ranks.
+ */
+uint64_t hdf5_io_get_storage_size(config_t *config,
+                                  config_workload_t *config_workload) {
+    uint64_t size = (uint64_t) H5Dget_storage_size(dset_g);
+    if (hdf5_io_is_core(config_workload))
+        MPI_Allreduce(MPI_IN_PLACE, &size, 1, MPI_UINT64_T, MPI_SUM,
+                      config->comm);
+    return size;
 }
 
 void hdf5_io_close_dataset(config_t *config,
@@ -157,19 +669,465 @@ void hdf5_io_close_dataset(config_t *config,
 
 void hdf5_io_open_dataset(config_t *config,
                           config_workload_t *config_workload) {
-    if (access(OUTPUT_FILENAME, F_OK) != 0) {
-        PRINT_ERROR_RANK0("Error: HDF5 file '%s' does not exist\n",
-                          OUTPUT_FILENAME);
+    char filename[MAX_NAME_SIZE];
+    hdf5_io_filename(config, config_workload, filename);
+    if (access(filename, F_OK) != 0) {
+        PRINT_ERROR_RANK0("Error: HDF5 file '%s' does not exist\n", filename);
+        if (hdf5_io_is_core(config_workload))
+            PRINT_ERROR_RANK0("Core files need backing_store on write\n");
         abort();
     }
 
-    fapl_g = H5Pcreate(H5P_FILE_ACCESS);
-    H5_ASSERT(fapl_g);
-    H5_ASSERT(H5Pset_fapl_mpio(fapl_g, MPI_COMM_WORLD, MPI_INFO_NULL));
-    file_g = H5Fopen("output.h5", H5F_ACC_RDONLY, fapl_g);
+    fapl_g = hdf5_io_create_fapl(config, config_workload);
+    file_g = H5Fopen(filename, H5F_ACC_RDONLY, fapl_g);
     H5_ASSERT(file_g);
     H5_ASSERT(H5Pclose(fapl_g));
 
-    dset_g = H5Dopen(file_g, DATASET_NAME, H5P_DEFAULT);
+    hid_t dapl = hdf5_io_create_dapl(config_workload);
+    dset_g = H5Dopen(file_g, DATASET_NAME, dapl);
     H5_ASSERT(dset_g);
+    H5_ASSERT(H5Pclose(dapl));
+}
+
+/**
+ * hdf5_async queues every chunk of a workload on one event set with the
+ * *_async calls and only waits for them at flush, so the whole I/O phase is
+ * left to the async VOL connector. Without the connector loaded the calls
+ * run synchronously, which is reported once per workload and through the
+ * vol= entry of backend_stats.
+ */
+static hid_t async_es_g = -1;
+// connector the file was opened with, see hdf5_async_io_start
+static char async_vol_name_g[MAX_NAME_SIZE] = "";
+
+#define ASYNC_VOL_NAME "async"
+
+static void hdf5_async_io_start(config_t *config) {
+    char *name = async_vol_name_g;
+    H5_ASSERT(H5VLget_connector_name(file_g, name, MAX_NAME_SIZE));
+    if (strcmp(name, ASYNC_VOL_NAME))
+        PRINT_RANK0("Warning: file uses the %s VOL connector, not %s, "
+                    "hdf5_async falls back to synchronous I/O\n",
+                    name, ASYNC_VOL_NAME);
+    else
+        PRINT_RANK0("Using the %s VOL connector\n", ASYNC_VOL_NAME);
+
+    async_es_g = H5EScreate();
+    H5_ASSERT(async_es_g);
+}
+
+void hdf5_async_io_create_dataset(config_t *config,
+                                  config_workload_t *config_workload) {
+    hdf5_io_create_dataset(config, config_workload);
+    hdf5_async_io_start(config);
+}
+
+void hdf5_async_io_open_dataset(config_t *config,
+                                config_workload_t *config_workload) {
+    hdf5_io_open_dataset(config, config_workload);
+    hdf5_async_io_start(config);
+}
+
+void hdf5_async_io_write_chunk(config_t *config,
+                               config_workload_t *config_workload,
+                               double *buffer) {
+    hid_t memspace, dxpl;
+    hdf5_io_select_chunk(config, &filespace_g, &memspace, &dxpl);
+
+    START_TIMER("hdf5.write");
+    H5_ASSERT(H5Dwrite_async(dset_g, H5T_NATIVE_DOUBLE, memspace, filespace_g,
+                             dxpl, buffer, async_es_g));
+    STOP_TIMER("hdf5.write");
+
+    H5_ASSERT(H5Pclose(dxpl));
+    H5_ASSERT(H5Sclose(memspace));
+    H5_ASSERT(H5Sclose(filespace_g));
+}
+
+void hdf5_async_io_read_chunk(config_t *config,
+                              config_workload_t *config_workload,
+                              double *buffer) {
+    hid_t memspace, dxpl;
+    hdf5_io_select_chunk(config, &filespace_g, &memspace, &dxpl);
+
+    START_TIMER("hdf5.read");
+    H5_ASSERT(H5Dread_async(dset_g, H5T_NATIVE_DOUBLE, memspace, filespace_g,
+                            dxpl, buffer, async_es_g));
+    STOP_TIMER("hdf5.read");
+
+    H5_ASSERT(H5Pclose(dxpl));
+    H5_ASSERT(H5Sclose(memspace));
+    H5_ASSERT(H5Sclose(filespace_g));
+}
+
+/**
+ * Queues the file flush behind the chunks and waits for the whole event
+ * set, which is where the connector's I/O time shows up.
+ */
+void hdf5_async_io_flush(config_t *config,
+                         config_workload_t *config_workload) {
+    size_t num_in_progress;
+    hbool_t op_failed;
+
+    // the queued chunks land first, so what the flush writes is metadata
+    START_TIMER("hdf5.es_wait");
+    H5_ASSERT(H5ESwait(async_es_g, H5ES_WAIT_FOREVER, &num_in_progress,
+                       &op_failed));
+    STOP_TIMER("hdf5.es_wait");
+    ASSERT(!op_failed, "Asynchronous HDF5 operation failed\n");
+
+    mpio_count_t before;
+    mpio_count_get(&before);
+    START_TIMER("hdf5.flush");
+    H5_ASSERT(H5Fflush_async(file_g, H5F_SCOPE_GLOBAL, async_es_g));
+    H5_ASSERT(H5ESwait(async_es_g, H5ES_WAIT_FOREVER, &num_in_progress,
+                       &op_failed));
+    STOP_TIMER("hdf5.flush");
+    ASSERT(!op_failed, "Asynchronous HDF5 flush failed\n");
+    hdf5_io_count_meta_writes(config, &before);
+    hdf5_io_record_file_stats(config, config_workload);
+
+    size_t len = strlen(config->backend_stats);
+    snprintf(&config->backend_stats[len], MAX_CONFIG_STRING_SIZE - len,
+             ";vol=%s", async_vol_name_g);
+}
+
+void hdf5_async_io_close_dataset(config_t *config,
+                                 config_workload_t *config_workload) {
+    H5_ASSERT(H5ESclose(async_es_g));
+    async_es_g = -1;
+    hdf5_io_close_dataset(config, config_workload);
+}
+
+/**
+ * hdf5_direct moves chunks with H5Dwrite_chunk and H5Dread_chunk and runs
+ * ZFP itself on a pool of worker threads, so the filter pipeline and its
+ * global lock are skipped in both directions. The dataset is created with
+ * the same ZFP filter, which keeps the chunks readable through H5Dread and
+ * the plugin. The main thread moves chunk k+1 while the workers code chunk
+ * k. Each rank accesses its chunks independently, so the config only
+ * allows it on the core driver, where every rank has a file of its own, or
+ * on a single rank.
+ */
+static bool direct_zfp_g = false;
+
+static void hdf5_direct_io_chunk_offset(config_t *config, uint64_t chunk,
+                                        hsize_t *offset) {
+    uint64_t chunk_offset[MAX_CONFIG_DIMS];
+    layout_chunk_offset(config, chunk, chunk_offset);
+    for (uint32_t d = 0; d < config->layout.ndims; d++)
+        offset[d] = chunk_offset[d];
+}
+
+static void hdf5_direct_io_put_chunk(config_t *config, uint64_t chunk,
+                                     const void *data, size_t size) {
+    hsize_t offset[MAX_CONFIG_DIMS];
+    hdf5_direct_io_chunk_offset(config, chunk, offset);
+
+    START_TIMER("hdf5.write_chunk");
+    H5_ASSERT(H5Dwrite_chunk(dset_g, H5P_DEFAULT, 0, offset, size, data));
+    STOP_TIMER("hdf5.write_chunk");
+}
+
+/**
+ * Retires the oldest pool job, writing it out if it was compressed. Workers
+ * time themselves, the samples are added here since the timers are only
+ * safe on the main thread.
+ */
+static bool hdf5_direct_io_retire(config_t *config,
+                                  config_workload_t *config_workload,
+                                  bool block) {
+    zfp_pool_result_t result;
+    START_TIMER("hdf5.zfp_wait");
+    bool retired = zfp_pool_retire(block, &result);
+    STOP_TIMER("hdf5.zfp_wait");
+    if (!retired) return false;
+
+    if (!strcmp(config_workload->io_type, "write")) {
+        timer_record("hdf5.zfp_compress", result.seconds);
+        hdf5_direct_io_put_chunk(config, result.tag, result.data,
+                                 result.size);
+    } else {
+        timer_record("hdf5.zfp_decompress", result.seconds);
+    }
+    free(result.data);
+    return true;
+}
+
+#define PROBE_FILENAME "zfp_probe.h5"
+
+/**
+ * Writes data, one chunk, through the H5Z-ZFP plugin into a dataset of an
+ * in-memory file that never reaches the disk. Returns the stored chunk as
+ * H5Dread_chunk sees it and the cd_values set_local left on the dataset,
+ * decoded receives what the plugin reads back.
+ */
+static void *hdf5_direct_io_plugin_chunk(config_t *config, const double *data,
+                                         size_t *size,
+                                         unsigned int *cd_values,
+                                         size_t *cd_nelmts, double *decoded) {
+    const config_layout_t *layout = &config->layout;
+    hsize_t chunk_dims[MAX_CONFIG_DIMS], offset[MAX_CONFIG_DIMS] = {0};
+    for (uint32_t d = 0; d < layout->ndims; d++)
+        chunk_dims[d] = layout->chunk_dims[d];
+
+    hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+    H5_ASSERT(fapl);
+    H5_ASSERT(H5Pset_fapl_core(fapl, layout->chunk_elements * sizeof(double),
+                               false));
+    hid_t file = H5Fcreate(PROBE_FILENAME, H5F_ACC_TRUNC, H5P_DEFAULT, fapl);
+    H5_ASSERT(file);
+    hid_t space = H5Screate_simple(layout->ndims, chunk_dims, NULL);
+    H5_ASSERT(space);
+    hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+    H5_ASSERT(dcpl);
+    H5_ASSERT(H5Pset_chunk(dcpl, layout->ndims, chunk_dims));
+    hdf5_io_set_zfp_filter(config, dcpl);
+
+    hid_t dset = H5Dcreate(file, DATASET_NAME, H5T_NATIVE_DOUBLE, space,
+                           H5P_DEFAULT, dcpl, H5P_DEFAULT);
+    H5_ASSERT(dset);
+    H5_ASSERT(H5Dwrite(dset, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+                       data));
+    // reopened so the chunk has left the chunk cache
+    H5_ASSERT(H5Dclose(dset));
+    dset = H5Dopen(file, DATASET_NAME, H5P_DEFAULT);
+    H5_ASSERT(dset);
+
+    unsigned int flags;
+    hid_t stored_dcpl = H5Dget_create_plist(dset);
+    H5_ASSERT(stored_dcpl);
+    H5_ASSERT(H5Pget_filter_by_id2(stored_dcpl, H5Z_FILTER_ZFP, &flags,
+                                   cd_nelmts, cd_values, 0, NULL, NULL));
+
+    hsize_t stored_size;
+    uint32_t filter_mask;
+    H5_ASSERT(H5Dget_chunk_storage_size(dset, offset, &stored_size));
+    void *chunk = malloc(stored_size);
+    ASSERT(chunk, "Failed to allocate %lu bytes\n", (uint64_t) stored_size);
+    H5_ASSERT(H5Dread_chunk(dset, H5P_DEFAULT, offset, &filter_mask, chunk));
+    *size = stored_size;
+    H5_ASSERT(H5Dread(dset, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+                      decoded));
+
+    H5_ASSERT(H5Pclose(stored_dcpl));
+    H5_ASSERT(H5Dclose(dset));
+    H5_ASSERT(H5Pclose(dcpl));
+    H5_ASSERT(H5Sclose(space));
+    H5_ASSERT(H5Fclose(file));
+    H5_ASSERT(H5Pclose(fapl));
+    return chunk;
+}
+
+/**
+ * H5Z-ZFP keeps the stream parameters in cd_values, whether it also writes
+ * a header into each chunk depends on the plugin and cannot be assumed. The
+ * pool compresses a probe chunk without and with a per-chunk header and
+ * the layout whose bytes equal the plugin's is used, so direct chunks stay
+ * interchangeable with filtered ones in every mode. The plugin's chunk is
+ * then decoded by the pool with that layout and must give back exactly the
+ * values the plugin reads. Aborts if neither layout matches. Only rank 0
+ * of the workload's communicator probes.
+ */
+static bool hdf5_direct_io_probe_chunk_header(config_t *config,
+                                              const unsigned int *cd_values,
+                                              size_t cd_nelmts) {
+    int chunk_header = -1, comm_rank;
+    MPI_Comm_rank(config->comm, &comm_rank);
+    START_TIMER("hdf5.zfp_probe");
+    if (comm_rank == 0) {
+        uint64_t n = config->layout.chunk_elements;
+        double *data = (double *) malloc(n * sizeof(double));
+        double *plugin_decoded = (double *) malloc(n * sizeof(double));
+        double *pool_decoded = (double *) malloc(n * sizeof(double));
+        ASSERT(data && plugin_decoded && pool_decoded,
+               "Failed to allocate the probe chunks\n");
+        // smooth with some fine structure, so lossy modes drop bits
+        for (uint64_t i = 0; i < n; i++)
+            data[i] = 1000.0 * sin(0.001 * i) + 0.25 * (i % 13);
+
+        unsigned int probe_cd_values[H5Z_ZFP_CD_NELMTS_MAX];
+        size_t probe_cd_nelmts = H5Z_ZFP_CD_NELMTS_MAX, plugin_size;
+        void *plugin = hdf5_direct_io_plugin_chunk(
+            config, data, &plugin_size, probe_cd_values, &probe_cd_nelmts,
+            plugin_decoded);
+        ASSERT(probe_cd_nelmts == cd_nelmts &&
+                   !memcmp(probe_cd_values, cd_values,
+                           cd_nelmts * sizeof(unsigned int)),
+               "The dataset was not written in zfp %s mode, a workload "
+               "must use the mode of the file it reads\n",
+               config->zfp.mode);
+
+        for (int layout = 0; layout < 2 && chunk_header < 0; layout++) {
+            zfp_pool_result_t result;
+            zfp_pool_init(&cd_values[1], cd_nelmts - 1, layout, 1, 1);
+            zfp_pool_submit_compress(data, 0);
+            zfp_pool_retire(true, &result);
+            zfp_pool_deinit();
+            if (result.size == plugin_size &&
+                !memcmp(result.data, plugin, plugin_size))
+                chunk_header = layout;
+            free(result.data);
+        }
+        ASSERT(chunk_header >= 0,
+               "hdf5_direct cannot reproduce the chunks H5Z-ZFP writes in "
+               "zfp %s mode\n",
+               config->zfp.mode);
+
+        zfp_pool_result_t result;
+        zfp_pool_init(&cd_values[1], cd_nelmts - 1, chunk_header, 1, 1);
+        zfp_pool_submit_decompress(plugin, plugin_size, pool_decoded, 0);
+        zfp_pool_retire(true, &result);
+        zfp_pool_deinit();
+        ASSERT(!memcmp(pool_decoded, plugin_decoded, n * sizeof(double)),
+               "hdf5_direct decodes H5Z-ZFP chunks differently from the "
+               "plugin in zfp %s mode\n",
+               config->zfp.mode);
+
+        free(result.data);
+        free(pool_decoded);
+        free(plugin_decoded);
+        free(data);
+        PRINT_RANK0("H5Z-ZFP chunks %s a ZFP header\n",
+                    chunk_header ? "carry" : "do not carry");
+    }
+    MPI_Bcast(&chunk_header, 1, MPI_INT, 0, config->comm);
+    STOP_TIMER("hdf5.zfp_probe");
+    return chunk_header;
+}
+
+/**
+ * Starts the pool from the ZFP header that set_local wrote into the
+ * dataset's cd_values, with the chunk layout the plugin uses. Datasets
+ * without a filter move raw chunks.
+ */
+static void hdf5_direct_io_start_pool(config_t *config,
+                                      config_workload_t *config_workload) {
+    hid_t dcpl = H5Dget_create_plist(dset_g);
+    H5_ASSERT(dcpl);
+    direct_zfp_g = H5Pget_nfilters(dcpl) > 0;
+    if (!direct_zfp_g) {
+        H5_ASSERT(H5Pclose(dcpl));
+        return;
+    }
+
+    unsigned int flags, cd_values[H5Z_ZFP_CD_NELMTS_MAX];
+    size_t cd_nelmts = H5Z_ZFP_CD_NELMTS_MAX;
+    H5_ASSERT(H5Pget_filter_by_id2(dcpl, H5Z_FILTER_ZFP, &flags, &cd_nelmts,
+                                   cd_values, 0, NULL, NULL));
+    H5_ASSERT(H5Pclose(dcpl));
+
+    uint32_t num_threads = omp_get_max_threads();
+    uint32_t max_jobs = 2 * num_threads;
+    if (max_jobs < config_workload->pipeline_depth)
+        max_jobs = config_workload->pipeline_depth;
+    bool chunk_header =
+        hdf5_direct_io_probe_chunk_header(config, cd_values, cd_nelmts);
+    PRINT_RANK0("Running ZFP on %u threads\n", num_threads);
+    zfp_pool_init(&cd_values[1], cd_nelmts - 1, chunk_header, num_threads,
+                  max_jobs);
+}
+
+void hdf5_direct_io_create_dataset(config_t *config,
+                                   config_workload_t *config_workload) {
+    hdf5_io_create_dataset(config, config_workload);
+    hdf5_direct_io_start_pool(config, config_workload);
+}
+
+void hdf5_direct_io_open_dataset(config_t *config,
+                                 config_workload_t *config_workload) {
+    hdf5_io_open_dataset(config, config_workload);
+    hdf5_direct_io_start_pool(config, config_workload);
+}
+
+/**
+ * Hands the chunk to the pool, or writes it right away without a filter.
+ * The buffer is in use until the chunk is retired.
+ */
+void hdf5_direct_io_submit_write_chunk(config_t *config,
+                                       config_workload_t *config_workload,
+                                       double *buffer) {
+    if (!direct_zfp_g) {
+        hdf5_direct_io_put_chunk(config, config->cur_chunk, buffer,
+                                 config->layout.chunk_elements *
+                                     sizeof(double));
+        return;
+    }
+
+    if (zfp_pool_full()) hdf5_direct_io_retire(config, config_workload, true);
+    zfp_pool_submit_compress(buffer, config->cur_chunk);
+}
+
+/**
+ * Fetches the stored bytes of the chunk and queues their decompression
+ * straight into buffer. Without a filter the chunk is read into buffer.
+ */
+void hdf5_direct_io_submit_read_chunk(config_t *config,
+                                      config_workload_t *config_workload,
+                                      double *buffer) {
+    hsize_t offset[MAX_CONFIG_DIMS];
+    hdf5_direct_io_chunk_offset(config, config->cur_chunk, offset);
+    uint32_t filter_mask = 0;
+
+    if (!direct_zfp_g) {
+        START_TIMER("hdf5.read_chunk");
+        H5_ASSERT(H5Dread_chunk(dset_g, H5P_DEFAULT, offset, &filter_mask,
+                                buffer));
+        STOP_TIMER("hdf5.read_chunk");
+        return;
+    }
+
+    if (zfp_pool_full()) hdf5_direct_io_retire(config, config_workload, true);
+
+    hsize_t size;
+    START_TIMER("hdf5.read_chunk");
+    H5_ASSERT(H5Dget_chunk_storage_size(dset_g, offset, &size));
+    void *data = malloc(size);
+    ASSERT(data, "Failed to allocate %lu bytes\n", (uint64_t) size);
+    H5_ASSERT(H5Dread_chunk(dset_g, H5P_DEFAULT, offset, &filter_mask, data));
+    STOP_TIMER("hdf5.read_chunk");
+    ASSERT(filter_mask == 0, "Chunk %lu was stored without the ZFP filter\n",
+           config->cur_chunk);
+
+    zfp_pool_submit_decompress(data, size, buffer, config->cur_chunk);
+}
+
+void hdf5_direct_io_write_chunk(config_t *config,
+                                config_workload_t *config_workload,
+                                double *buffer) {
+    hdf5_direct_io_submit_write_chunk(config, config_workload, buffer);
+    // write whatever the workers have finished in the meantime
+    if (direct_zfp_g)
+        while (hdf5_direct_io_retire(config, config_workload, false));
+}
+
+void hdf5_direct_io_read_chunk(config_t *config,
+                               config_workload_t *config_workload,
+                               double *buffer) {
+    hdf5_direct_io_submit_read_chunk(config, config_workload, buffer);
+    if (direct_zfp_g)
+        while (hdf5_direct_io_retire(config, config_workload, false));
+}
+
+/**
+ * Once this returns the oldest submitted chunk is on storage or decoded
+ * into its buffer, chunks retired earlier are skipped.
+ */
+void hdf5_direct_io_complete_chunk(config_t *config,
+                                   config_workload_t *config_workload) {
+    if (direct_zfp_g) hdf5_direct_io_retire(config, config_workload, true);
+}
+
+void hdf5_direct_io_flush(config_t *config,
+                          config_workload_t *config_workload) {
+    if (direct_zfp_g)
+        while (hdf5_direct_io_retire(config, config_workload, true));
+    hdf5_io_flush(config, config_workload);
+}
+
+void hdf5_direct_io_close_dataset(config_t *config,
+                                  config_workload_t *config_workload) {
+    if (direct_zfp_g) zfp_pool_deinit();
+    direct_zfp_g = false;
+    hdf5_io_close_dataset(config, config_workload);
 }
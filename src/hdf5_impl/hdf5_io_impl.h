@@ -33,6 +33,62 @@ void hdf5_io_write_chunk(config_t *config, config_workload_t *config_workload,
                          double *buffer);
 void hdf5_io_read_chunk(config_t *config, config_workload_t *config_workload,
                         double *buffer);
+void hdf5_io_write_chunks(config_t *config, config_workload_t *config_workload,
+                          double *buffer);
+void hdf5_io_read_chunks(config_t *config, config_workload_t *config_workload,
+                         double *buffer);
 void hdf5_io_flush(config_t *config, config_workload_t *config_workload);
+void hdf5_io_submit_write_chunk(config_t *config,
+                                config_workload_t *config_workload,
+                                double *buffer);
+void hdf5_io_submit_read_chunk(config_t *config,
+                               config_workload_t *config_workload,
+                               double *buffer);
+void hdf5_io_complete_chunk(config_t *config,
+                            config_workload_t *config_workload);
+void hdf5_io_store_checksums(config_t *config,
+                             config_workload_t *config_workload,
+                             uint64_t *checksums);
+void hdf5_io_load_checksums(config_t *config,
+                            config_workload_t *config_workload,
+                            uint64_t *checksums);
+uint64_t hdf5_io_get_storage_size(config_t *config,
+                                  config_workload_t *config_workload);
+
+void hdf5_async_io_create_dataset(config_t *config,
+                                  config_workload_t *config_workload);
+void hdf5_async_io_open_dataset(config_t *config,
+                                config_workload_t *config_workload);
+void hdf5_async_io_write_chunk(config_t *config,
+                               config_workload_t *config_workload,
+                               double *buffer);
+void hdf5_async_io_read_chunk(config_t *config,
+                              config_workload_t *config_workload,
+                              double *buffer);
+void hdf5_async_io_flush(config_t *config, config_workload_t *config_workload);
+void hdf5_async_io_close_dataset(config_t *config,
+                                 config_workload_t *config_workload);
+
+void hdf5_direct_io_create_dataset(config_t *config,
+                                   config_workload_t *config_workload);
+void hdf5_direct_io_open_dataset(config_t *config,
+                                 config_workload_t *config_workload);
+void hdf5_direct_io_write_chunk(config_t *config,
+                                config_workload_t *config_workload,
+                                double *buffer);
+void hdf5_direct_io_submit_write_chunk(config_t *config,
+                                       config_workload_t *config_workload,
+                                       double *buffer);
+void hdf5_direct_io_read_chunk(config_t *config,
+                               config_workload_t *config_workload,
+                               double *buffer);
+void hdf5_direct_io_submit_read_chunk(config_t *config,
+                                      config_workload_t *config_workload,
+                                      double *buffer);
+void hdf5_direct_io_complete_chunk(config_t *config,
+                                   config_workload_t *config_workload);
+void hdf5_direct_io_flush(config_t *config, config_workload_t *config_workload);
+void hdf5_direct_io_close_dataset(config_t *config,
+                                  config_workload_t *config_workload);
 
 #endif
\ No newline at end of file
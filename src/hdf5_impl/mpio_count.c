@@ -0,0 +1,49 @@
+#include <mpi.h>
+
+#include "mpio_count.h"
+
+static mpio_count_t count_g = {0, 0, 0.0};
+
+static void mpio_count_add(MPI_Datatype datatype, int count, double start) {
+    int type_size;
+    PMPI_Type_size(datatype, &type_size);
+    count_g.writes++;
+    count_g.bytes += (uint64_t) type_size * count;
+    count_g.seconds += MPI_Wtime() - start;
+}
+
+void mpio_count_get(mpio_count_t *count) { *count = count_g; }
+
+int MPI_File_write_at(MPI_File fh, MPI_Offset offset, const void *buf,
+                      int count, MPI_Datatype datatype, MPI_Status *status) {
+    double start = MPI_Wtime();
+    int ret = PMPI_File_write_at(fh, offset, buf, count, datatype, status);
+    mpio_count_add(datatype, count, start);
+    return ret;
+}
+
+int MPI_File_write_at_all(MPI_File fh, MPI_Offset offset, const void *buf,
+                          int count, MPI_Datatype datatype,
+                          MPI_Status *status) {
+    double start = MPI_Wtime();
+    int ret =
+        PMPI_File_write_at_all(fh, offset, buf, count, datatype, status);
+    mpio_count_add(datatype, count, start);
+    return ret;
+}
+
+int MPI_File_write(MPI_File fh, const void *buf, int count,
+                   MPI_Datatype datatype, MPI_Status *status) {
+    double start = MPI_Wtime();
+    int ret = PMPI_File_write(fh, buf, count, datatype, status);
+    mpio_count_add(datatype, count, start);
+    return ret;
+}
+
+int MPI_File_write_all(MPI_File fh, const void *buf, int count,
+                       MPI_Datatype datatype, MPI_Status *status) {
+    double start = MPI_Wtime();
+    int ret = PMPI_File_write_all(fh, buf, count, datatype, status);
+    mpio_count_add(datatype, count, start);
+    return ret;
+}
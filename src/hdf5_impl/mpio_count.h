@@ -0,0 +1,26 @@
+#ifndef MPIO_COUNT_H
+#define MPIO_COUNT_H
+
+#include <stdint.h>
+
+/**
+ * Counts the MPI-IO writes made through MPI_File_write_at, _write_at_all,
+ * _write and _write_all by interposing on them with the PMPI profiling
+ * interface, so the calls HDF5's MPI-IO driver makes can be counted and
+ * timed without touching HDF5. Only the calls themselves are seen, the MPI
+ * library's internal I/O is not.
+ *
+ * The counters are plain globals. HDF5 makes its MPI-IO calls from the main
+ * thread or, with the async VOL connector, from its single background
+ * thread, so only one thread adds to them at a time.
+ */
+typedef struct mpio_count_t {
+    uint64_t writes;
+    uint64_t bytes;
+    double seconds;
+} mpio_count_t;
+
+// Totals since the start of the run, take the difference of two snapshots
+void mpio_count_get(mpio_count_t *count);
+
+#endif
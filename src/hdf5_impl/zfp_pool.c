@@ -0,0 +1,207 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mpi.h>
+#include <zfp.h>
+
+#include "zfp_pool.h"
+#include "../common/log.h"
+
+// enough for a full ZFP header, which is at most 148 bits
+#define MAX_HEADER_WORDS 16
+
+typedef struct zfp_pool_job_t {
+    bool decompress;
+    double *chunk;
+    zfp_pool_result_t result;
+    bool done;
+} zfp_pool_job_t;
+
+// bitstream reads 64 bit words, keep the header aligned and padded for it
+static uint64_t header_g[MAX_HEADER_WORDS / 2];
+// whether every chunk carries a full ZFP header ahead of its stream
+static bool chunk_header_g = false;
+
+static pthread_t *threads_g = NULL;
+static uint32_t num_threads_g = 0;
+
+static pthread_mutex_t lock_g = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_cond_g = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t done_cond_g = PTHREAD_COND_INITIALIZER;
+
+// ring of jobs, [head, next) are taken by workers, [next, tail) are queued
+static zfp_pool_job_t *jobs_g = NULL;
+static uint32_t max_jobs_g = 0;
+static uint64_t head_g = 0;
+static uint64_t next_g = 0;
+static uint64_t tail_g = 0;
+static bool stop_g = false;
+
+/**
+ * Every worker reads the header into its own stream and field, neither is
+ * safe to share between threads.
+ */
+static void zfp_pool_open_stream(zfp_stream **stream, zfp_field **field) {
+    bitstream *header = stream_open(header_g, sizeof(header_g));
+    *stream = zfp_stream_open(header);
+    *field = zfp_field_alloc();
+    ASSERT(zfp_read_header(*stream, *field, ZFP_HEADER_FULL),
+           "Failed to read the ZFP header from the dataset's cd_values\n");
+    zfp_stream_set_bit_stream(*stream, NULL);
+    stream_close(header);
+}
+
+static void zfp_pool_compress(zfp_stream *stream, zfp_field *field,
+                              zfp_pool_job_t *job) {
+    zfp_field_set_pointer(field, job->chunk);
+    size_t max_size = zfp_stream_maximum_size(stream, field);
+    job->result.data = malloc(max_size);
+    ASSERT(job->result.data, "Failed to allocate %zu bytes\n", max_size);
+
+    bitstream *out = stream_open(job->result.data, max_size);
+    zfp_stream_set_bit_stream(stream, out);
+    zfp_stream_rewind(stream);
+    if (chunk_header_g)
+        ASSERT(zfp_write_header(stream, field, ZFP_HEADER_FULL),
+               "Failed to write the ZFP header of chunk %lu\n",
+               job->result.tag);
+    job->result.size = zfp_compress(stream, field);
+    ASSERT(job->result.size, "zfp_compress failed on chunk %lu\n",
+           job->result.tag);
+    zfp_stream_set_bit_stream(stream, NULL);
+    stream_close(out);
+}
+
+static void zfp_pool_decompress(zfp_stream *stream, zfp_field *field,
+                                zfp_pool_job_t *job) {
+    bitstream *in = stream_open(job->result.data, job->result.size);
+    zfp_stream_set_bit_stream(stream, in);
+    zfp_stream_rewind(stream);
+    if (chunk_header_g)
+        ASSERT(zfp_read_header(stream, field, ZFP_HEADER_FULL),
+               "Failed to read the ZFP header of chunk %lu\n",
+               job->result.tag);
+    zfp_field_set_pointer(field, job->chunk);
+    ASSERT(zfp_decompress(stream, field),
+           "zfp_decompress failed on chunk %lu\n", job->result.tag);
+    zfp_stream_set_bit_stream(stream, NULL);
+    stream_close(in);
+}
+
+static void *zfp_pool_worker(void *arg) {
+    zfp_stream *stream;
+    zfp_field *field;
+    zfp_pool_open_stream(&stream, &field);
+
+    pthread_mutex_lock(&lock_g);
+    while (true) {
+        while (!stop_g && next_g == tail_g)
+            pthread_cond_wait(&work_cond_g, &lock_g);
+        if (stop_g) break;
+
+        zfp_pool_job_t *job = &jobs_g[next_g++ % max_jobs_g];
+        pthread_mutex_unlock(&lock_g);
+        double start = MPI_Wtime();
+        if (job->decompress)
+            zfp_pool_decompress(stream, field, job);
+        else
+            zfp_pool_compress(stream, field, job);
+        job->result.seconds = MPI_Wtime() - start;
+        pthread_mutex_lock(&lock_g);
+
+        job->done = true;
+        pthread_cond_broadcast(&done_cond_g);
+    }
+    pthread_mutex_unlock(&lock_g);
+
+    zfp_field_free(field);
+    zfp_stream_close(stream);
+    return NULL;
+}
+
+void zfp_pool_init(const unsigned int *header, size_t header_words,
+                   bool chunk_header, uint32_t num_threads,
+                   uint32_t max_jobs) {
+    ASSERT(header_words <= MAX_HEADER_WORDS,
+           "ZFP header of %zu words does not fit in %d\n", header_words,
+           MAX_HEADER_WORDS);
+    ASSERT(num_threads > 0 && max_jobs > 0,
+           "ZFP pool needs at least one thread and job\n");
+    memset(header_g, 0, sizeof(header_g));
+    memcpy(header_g, header, header_words * sizeof(unsigned int));
+    chunk_header_g = chunk_header;
+
+    jobs_g = (zfp_pool_job_t *) calloc(max_jobs, sizeof(zfp_pool_job_t));
+    max_jobs_g = max_jobs;
+    head_g = next_g = tail_g = 0;
+    stop_g = false;
+
+    threads_g = (pthread_t *) malloc(num_threads * sizeof(pthread_t));
+    num_threads_g = num_threads;
+    for (uint32_t i = 0; i < num_threads; i++)
+        ASSERT(!pthread_create(&threads_g[i], NULL, zfp_pool_worker, NULL),
+               "Failed to start ZFP worker %u\n", i);
+}
+
+void zfp_pool_deinit(void) {
+    ASSERT(head_g == tail_g, "ZFP pool closed with %lu jobs pending\n",
+           tail_g - head_g);
+
+    pthread_mutex_lock(&lock_g);
+    stop_g = true;
+    pthread_cond_broadcast(&work_cond_g);
+    pthread_mutex_unlock(&lock_g);
+    for (uint32_t i = 0; i < num_threads_g; i++)
+        pthread_join(threads_g[i], NULL);
+
+    free(threads_g);
+    free(jobs_g);
+    threads_g = NULL;
+    jobs_g = NULL;
+    num_threads_g = 0;
+}
+
+bool zfp_pool_full(void) { return tail_g - head_g == max_jobs_g; }
+
+uint32_t zfp_pool_pending(void) { return (uint32_t) (tail_g - head_g); }
+
+static void zfp_pool_submit(bool decompress, double *chunk, void *data,
+                            size_t size, uint64_t tag) {
+    ASSERT(!zfp_pool_full(), "ZFP pool already holds %u jobs\n", max_jobs_g);
+
+    pthread_mutex_lock(&lock_g);
+    zfp_pool_job_t *job = &jobs_g[tail_g++ % max_jobs_g];
+    memset(job, 0, sizeof(*job));
+    job->decompress = decompress;
+    job->chunk = chunk;
+    job->result.tag = tag;
+    job->result.data = data;
+    job->result.size = size;
+    pthread_cond_signal(&work_cond_g);
+    pthread_mutex_unlock(&lock_g);
+}
+
+void zfp_pool_submit_compress(const double *chunk, uint64_t tag) {
+    // compression only reads the chunk
+    zfp_pool_submit(false, (double *) chunk, NULL, 0, tag);
+}
+
+void zfp_pool_submit_decompress(void *data, size_t size, double *chunk,
+                                uint64_t tag) {
+    zfp_pool_submit(true, chunk, data, size, tag);
+}
+
+bool zfp_pool_retire(bool block, zfp_pool_result_t *result) {
+    if (head_g == tail_g) return false;
+
+    zfp_pool_job_t *job = &jobs_g[head_g % max_jobs_g];
+    pthread_mutex_lock(&lock_g);
+    while (block && !job->done) pthread_cond_wait(&done_cond_g, &lock_g);
+    bool done = job->done;
+    pthread_mutex_unlock(&lock_g);
+    if (!done) return false;
+
+    *result = job->result;
+    head_g++;
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef ZFP_POOL_H
+#define ZFP_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Worker threads compressing and decompressing chunks with libzfp outside of
+ * HDF5. The stream mode and field shape come from the ZFP header H5Z-ZFP
+ * stored in the dataset's cd_values. Whether a chunk also carries a header
+ * of its own is up to the caller, which has to match the filter for the
+ * chunks to be interchangeable with the plugin's.
+ *
+ * Jobs are queued from the main thread and retired in submission order. The
+ * chunk buffer must stay valid until its job is retired. The pool is not
+ * thread safe itself, only the main thread submits and retires.
+ */
+typedef struct zfp_pool_result_t {
+    // tag given at submit, the chunk index for the HDF5 backend
+    uint64_t tag;
+    // compressed bytes, owned by the caller after retire in both directions
+    void *data;
+    size_t size;
+    // time the worker spent inside zfp_compress or zfp_decompress
+    double seconds;
+} zfp_pool_result_t;
+
+/**
+ * Starts num_threads workers. header points at the ZFP header words, for
+ * H5Z-ZFP that is cd_values[1..cd_nelmts). With chunk_header every
+ * compressed chunk starts with its own full ZFP header, which decompression
+ * reads back, otherwise chunks hold the bare stream. At most max_jobs
+ * chunks can be queued or finished but not retired.
+ */
+void zfp_pool_init(const unsigned int *header, size_t header_words,
+                   bool chunk_header, uint32_t num_threads,
+                   uint32_t max_jobs);
+// Joins the workers, every job must have been retired
+void zfp_pool_deinit(void);
+bool zfp_pool_full(void);
+uint32_t zfp_pool_pending(void);
+void zfp_pool_submit_compress(const double *chunk, uint64_t tag);
+/**
+ * Decompresses size bytes of data straight into chunk. The pool takes data
+ * and hands it back in the result so the caller can free or reuse it.
+ */
+void zfp_pool_submit_decompress(void *data, size_t size, double *chunk,
+                                uint64_t tag);
+/**
+ * Retires the oldest job. Returns false if there is none or, when block is
+ * false, if it has not finished yet.
+ */
+bool zfp_pool_retire(bool block, zfp_pool_result_t *result);
+
+#endif
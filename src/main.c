@@ -12,14 +12,151 @@
 #include "common/common.h"
 #include "common/log.h"
 #include "common/config.h"
+#include "common/layout.h"
 #include "hdf5_impl/hdf5_io_impl.h"
 #include "pdc_impl/pdc_io_impl.h"
 #include "exec_io_impl.h"
 
 #define USAGE "./zfp_baseline <json_config_path>"
 
+/**
+ * Runs one workload with the current sweep point, filter, io participation
+ * and zfp mode and appends its timers to the results.
+ */
+static void run_workload(io_impl_funcs_t io_impl_funcs, config_t *config,
+                         config_workload_t *config_workload) {
+    layout_init(config, config_workload);
+    uint64_t total_GB = config->total_bytes / (1024ULL * 1024 * 1024);
+    char chunk_dims[MAX_CONFIG_STRING_SIZE];
+    char global_dims[MAX_CONFIG_STRING_SIZE];
+    layout_dims_string(config->layout.chunk_dims, config->layout.ndims,
+                       chunk_dims, sizeof(chunk_dims));
+    layout_dims_string(config->layout.global_dims, config->layout.ndims,
+                       global_dims, sizeof(global_dims));
+
+    // print workload run information
+    MPI_Barrier(config->comm);
+    TOGGLE_COLOR(COLOR_GREEN);
+    PRINT_RANK0("==============================================\n");
+    PRINT_RANK0("Starting workload %s (sweep point %u)\n",
+                config_workload->name, config->sweep_point);
+    PRINT_RANK0("Running with %d rank(s)\n", config->num_ranks);
+    PRINT_RANK0("Chunks per rank %lu\n", config->chunks_per_rank);
+    PRINT_RANK0("Params %s", config_workload->params);
+    PRINT_RANK0("IO participation %s\n", config->io_participation);
+    PRINT_RANK0("Filter %s, ZFP mode %s (%g)\n", config_workload->io_filter,
+                config->zfp.mode, config->zfp.param);
+    PRINT_RANK0("Requested chunk size %lu bytes\n", config->chunk_size_bytes);
+    PRINT_RANK0("Chunk dims: %s, global dims: %s\n", chunk_dims, global_dims);
+    PRINT_RANK0("Total data to be written: %lu GB (%lu) bytes\n", total_GB,
+                config->total_bytes);
+    PRINT_RANK0("IO type: %s\n", config_workload->io_type);
+    PRINT_RANK0("Data generator: %s\n", config_workload->datagen.type);
+    PRINT_RANK0("Verify: %s\n", config_workload->verify);
+    PRINT_RANK0("Driver: %s (pipeline depth %u)\n", config_workload->driver,
+                config_workload->pipeline_depth);
+    PRINT_RANK0("Iterations: %u\n", config_workload->iterations);
+    PRINT_RANK0("Region partition: %s\n",
+                config_region_partition(config_workload));
+    PRINT_RANK0("==============================================\n");
+    TOGGLE_COLOR(COLOR_RESET);
+    MPI_Barrier(config->comm);
+
+    // start workload, timers are scoped to a single run
+    timers_reset();
+    exec_io_impl(io_impl_funcs, config, config_workload);
+
+    // print workload finished information
+    MPI_Barrier(config->comm);
+    TOGGLE_COLOR(COLOR_GREEN);
+    PRINT_RANK0("==============================================\n");
+    print_all_timers_csv(config, config_workload);
+    PRINT_RANK0("Finished workload %s\n", config_workload->name);
+    PRINT_RANK0("==============================================\n");
+    TOGGLE_COLOR(COLOR_RESET);
+    MPI_Barrier(config->comm);
+}
+
+/**
+ * Runs every filter of the workload with every io participation and, for zfp
+ * filters, every zfp mode.
+ */
+static void run_filters(io_impl_funcs_t io_impl_funcs, config_t *config,
+                        config_workload_t *config_workload) {
+    static const config_zfp_t no_zfp = {"none", 0.0};
+
+    for (uint32_t f = 0; f < config_workload->num_io_filters; f++) {
+        strcpy(config_workload->io_filter, config_workload->io_filters[f]);
+        bool zfp = config_filter_is_zfp(config_workload);
+
+        // every io participation is run with every zfp mode
+        uint32_t num_zfp_modes = zfp ? config_workload->num_zfp_modes : 1;
+        uint32_t num_runs =
+            config_workload->num_io_participations * num_zfp_modes;
+        for (uint32_t j = 0; j < num_runs; j++) {
+            strcpy(config->io_participation,
+                   config_workload->io_participations[j / num_zfp_modes]);
+            config->zfp = no_zfp;
+            if (zfp)
+                config->zfp = config_workload->zfp_modes[j % num_zfp_modes];
+            run_workload(io_impl_funcs, config, config_workload);
+        }
+    }
+}
+
+/**
+ * Runs every workload at the current sweep point, PDC workloads once per
+ * region partition. Reads see whatever the last write at this sweep point
+ * left behind.
+ */
+static void run_sweep_point(io_impl_funcs_t *io_impl_funcs, config_t *config) {
+    for (uint32_t i = 0; i < config->num_workloads; i++) {
+        config_workload_t *config_workload = &config->workloads[i];
+        io_impl_t cur_io_impl = -1;
+        for (int j = 0; j < NUM_IO_IMPL; j++) {
+            if (strcmp(config_workload->implementation,
+                       io_impl_strings[j]) == 0) {
+                cur_io_impl = j;
+                break;
+            }
+        }
+        ASSERT((int) cur_io_impl != -1,
+               "Failed to find io implementation for workload %s\n",
+               config_workload->implementation);
+
+        // only PDC objects have a region partition
+        config_pdc_t *pdc = &config_workload->pdc;
+        uint32_t num_partitions =
+            cur_io_impl == PDC_IMPL || cur_io_impl == PDC_ZFP_IMPL
+                ? pdc->num_region_partitions
+                : 1;
+        for (uint32_t p = 0; p < num_partitions; p++) {
+            strcpy(pdc->region_partition, pdc->region_partitions[p]);
+            run_filters(io_impl_funcs[cur_io_impl], config, config_workload);
+        }
+    }
+}
+
+/**
+ * Subfiling's I/O concentrator threads and the async VOL connector's
+ * background thread make MPI calls of their own. Without
+ * MPI_THREAD_MULTIPLE subfiling workloads fail the run, anything else
+ * only warns.
+ */
+static void check_thread_support(config_t *config, int thread_support) {
+    if (thread_support >= MPI_THREAD_MULTIPLE) return;
+    for (uint32_t i = 0; i < config->num_workloads; i++)
+        ASSERT(strcmp(config_file_driver(&config->workloads[i]), "subfiling"),
+               "Workload %s uses subfiling, which needs MPI_THREAD_MULTIPLE\n",
+               config->workloads[i].name);
+    PRINT_RANK0("Warning: MPI does not provide MPI_THREAD_MULTIPLE, which the "
+                "async VOL connector needs\n");
+}
+
 int main(int argc, char **argv) {
-    MPI_Init(&argc, &argv);
+    // subfiling and the HDF5 async VOL connector need MPI_THREAD_MULTIPLE
+    int thread_support;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &thread_support);
 
     int my_rank, num_ranks;
     MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
@@ -27,10 +164,12 @@ int main(int argc, char **argv) {
 
     char *config_path = argv[1];
     config_t *config = init_config(config_path);
+    check_thread_support(config, thread_support);
 
-    // set the number of ranks
+    // set the number of ranks, sweep points may use fewer
     config->num_ranks = num_ranks;
     config->my_rank = my_rank;
+    config->comm = MPI_COMM_WORLD;
 
     io_impl_funcs_t io_impl_funcs[NUM_IO_IMPL] = {
         [HDF5_IMPL] = {.init = hdf5_io_init,
@@ -40,7 +179,45 @@ int main(int argc, char **argv) {
                        .read_chunk = hdf5_io_read_chunk,
                        .flush = hdf5_io_flush,
                        .close_dataset = hdf5_io_close_dataset,
-                       .open_dataset = hdf5_io_open_dataset},
+                       .open_dataset = hdf5_io_open_dataset,
+                       .submit_write_chunk = hdf5_io_submit_write_chunk,
+                       .submit_read_chunk = hdf5_io_submit_read_chunk,
+                       .complete_chunk = hdf5_io_complete_chunk,
+                       .write_chunks = hdf5_io_write_chunks,
+                       .read_chunks = hdf5_io_read_chunks,
+                       .store_checksums = hdf5_io_store_checksums,
+                       .load_checksums = hdf5_io_load_checksums,
+                       .get_storage_size = hdf5_io_get_storage_size},
+        [HDF5_DIRECT_IMPL] =
+            {.init = hdf5_io_init,
+             .deinit = hdf5_io_deinit,
+             .create_dataset = hdf5_direct_io_create_dataset,
+             .write_chunk = hdf5_direct_io_write_chunk,
+             .read_chunk = hdf5_direct_io_read_chunk,
+             .flush = hdf5_direct_io_flush,
+             .close_dataset = hdf5_direct_io_close_dataset,
+             .open_dataset = hdf5_direct_io_open_dataset,
+             .submit_write_chunk = hdf5_direct_io_submit_write_chunk,
+             .submit_read_chunk = hdf5_direct_io_submit_read_chunk,
+             .complete_chunk = hdf5_direct_io_complete_chunk,
+             .store_checksums = hdf5_io_store_checksums,
+             .load_checksums = hdf5_io_load_checksums,
+             .get_storage_size = hdf5_io_get_storage_size},
+        [HDF5_ASYNC_IMPL] =
+            {.init = hdf5_io_init,
+             .deinit = hdf5_io_deinit,
+             .create_dataset = hdf5_async_io_create_dataset,
+             .write_chunk = hdf5_async_io_write_chunk,
+             .read_chunk = hdf5_async_io_read_chunk,
+             .flush = hdf5_async_io_flush,
+             .close_dataset = hdf5_async_io_close_dataset,
+             .open_dataset = hdf5_async_io_open_dataset,
+             .submit_write_chunk = hdf5_io_submit_write_chunk,
+             .submit_read_chunk = hdf5_io_submit_read_chunk,
+             .complete_chunk = hdf5_io_complete_chunk,
+             .store_checksums = hdf5_io_store_checksums,
+             .load_checksums = hdf5_io_load_checksums,
+             .get_storage_size = hdf5_io_get_storage_size},
         [PDC_IMPL] = {.init = pdc_io_init,
                       .deinit = pdc_io_deinit,
                       .create_dataset = pdc_io_create_dataset,
@@ -48,66 +225,49 @@ int main(int argc, char **argv) {
                       .read_chunk = pdc_io_read_chunk,
                       .flush = pdc_io_flush,
                       .close_dataset = pdc_io_close_dataset,
-                      .open_dataset = pdc_io_open_dataset}};
+                      .open_dataset = pdc_io_open_dataset,
+                      .submit_write_chunk = pdc_io_submit_write_chunk,
+                      .submit_read_chunk = pdc_io_submit_read_chunk,
+                      .complete_chunk = pdc_io_complete_chunk,
+                      .store_checksums = pdc_io_store_checksums,
+                      .load_checksums = pdc_io_load_checksums,
+                      .get_storage_size = pdc_io_get_storage_size}};
 
-    for (uint32_t i = 0; i < config->num_workloads; i++) {
-        io_impl_t cur_io_impl = -1;
-        for (int j = 0; j < NUM_IO_IMPL; j++) {
-            if (strcmp(config->workloads[i].implementation,
-                       io_impl_strings[j]) == 0) {
-                cur_io_impl = j;
-                break;
+    // sweep over every combination of rank count, chunk size and chunks
+    // per rank, ranks outside the current rank count wait for the next point
+    if (config->num_rank_counts == 0) {
+        config->num_rank_counts = 1;
+        config->rank_counts[0] = num_ranks;
+    }
+    config->sweep_point = 0;
+    for (uint32_t r = 0; r < config->num_rank_counts; r++) {
+        int point_ranks = config->rank_counts[r];
+        ASSERT(point_ranks <= num_ranks,
+               "Sweep needs %d ranks, job has %d\n", point_ranks, num_ranks);
+
+        // the full job keeps MPI_COMM_WORLD, libraries expect it there
+        MPI_Comm comm = MPI_COMM_WORLD;
+        if (point_ranks < num_ranks)
+            MPI_Comm_split(MPI_COMM_WORLD,
+                           my_rank < point_ranks ? 0 : MPI_UNDEFINED, my_rank,
+                           &comm);
+        config->comm = comm;
+        config->num_ranks = point_ranks;
+
+        for (uint32_t s = 0; s < config->num_chunk_sizes; s++) {
+            for (uint32_t c = 0; c < config->num_chunks_per_rank_values;
+                 c++) {
+                config->chunk_size_bytes = config->chunk_sizes[s];
+                config->chunks_per_rank = config->chunks_per_rank_values[c];
+                if (comm != MPI_COMM_NULL)
+                    run_sweep_point(io_impl_funcs, config);
+                config->sweep_point++;
+                MPI_Barrier(MPI_COMM_WORLD);
             }
         }
-        ASSERT((int) cur_io_impl != -1,
-               "Failed to find io implementation for workload %s\n",
-               config->workloads[i].implementation);
-
-        for (uint32_t j = 0; j < config->workloads[i].num_io_participations;
-             j++) {
-            config->elements_per_dim =
-                (uint32_t) sqrt(config->chunk_size_bytes / sizeof(double));
-            config->total_bytes = (uint64_t) config->chunks_per_rank *
-                                  num_ranks * config->elements_per_dim *
-                                  config->elements_per_dim * sizeof(double);
-            uint64_t total_GB = config->total_bytes / (1024ULL * 1024 * 1024);
-            strcpy(config->io_participation,
-                   config->workloads[i].io_participations[j]);
-
-            // print workload run information
-            MPI_Barrier(MPI_COMM_WORLD);
-            TOGGLE_COLOR(COLOR_GREEN);
-            PRINT_RANK0("==============================================\n");
-            PRINT_RANK0("Starting workload %s\n", config->workloads[i].name);
-            PRINT_RANK0("Running with %d rank(s)\n", num_ranks);
-            PRINT_RANK0("Chunks per rank %lu\n", config->chunks_per_rank);
-            PRINT_RANK0("Params %s", config->workloads[i].params);
-            PRINT_RANK0("IO participation %s\n", config->io_participation);
-            PRINT_RANK0("Requested chunk size %lu bytes\n",
-                        config->chunk_size_bytes);
-            PRINT_RANK0("Elements per dimension: %lu\n",
-                        config->elements_per_dim);
-            PRINT_RANK0("Total data to be written: %lu GB (%lu) bytes\n",
-                        total_GB, config->total_bytes);
-            PRINT_RANK0("IO type: %s\n", config->workloads[i].io_type);
-            PRINT_RANK0("==============================================\n");
-            TOGGLE_COLOR(COLOR_RESET);
-            MPI_Barrier(MPI_COMM_WORLD);
-
-            // start workload
-            exec_io_impl(io_impl_funcs[cur_io_impl], config,
-                         &(config->workloads[i]));
-
-            // print workload finished information
-            MPI_Barrier(MPI_COMM_WORLD);
-            TOGGLE_COLOR(COLOR_GREEN);
-            PRINT_RANK0("==============================================\n");
-            print_all_timers_csv(config, &(config->workloads[i]));
-            PRINT_RANK0("Finished workload %s\n", config->workloads[i].name);
-            PRINT_RANK0("==============================================\n");
-            TOGGLE_COLOR(COLOR_RESET);
-            MPI_Barrier(MPI_COMM_WORLD);
-        }
+
+        if (comm != MPI_COMM_NULL && comm != MPI_COMM_WORLD)
+            MPI_Comm_free(&comm);
     }
 
     MPI_Finalize();
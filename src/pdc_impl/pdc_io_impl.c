@@ -1,13 +1,19 @@
 #include <mpi.h>
+#include <stdlib.h>
 
 #include "pdc_io_impl.h"
+#include "pdc_server_log.h"
 #include "../common/util.h"
 #include "../common/common.h"
 #include "../common/log.h"
 #include "../common/config.h"
+#include "../common/layout.h"
 
-#define TF_GRAPHS_DIR "/pscratch/sd/n/nlewi26/src/hdf5-zfp-baseline/tf_graphs/"
 #include "pdc.h"
+#include "json-c/json.h"
+
+#define MAX_TF_FUNCTIONS 16
+#define TF_TIMER_PREFIX "pdc.tf."
 
 /**
  * NOTE: we don't close and reopen the container
@@ -19,9 +25,38 @@ static pdcid_t cont_prop_g = 0;
 static pdcid_t obj_prop_g = 0;
 static pdcid_t obj_g = 0;
 static pdcid_t dg_id_g = 0;
-static uint64_t dims[2];
+// functions of the transform graph, their server times are collected
+static char tf_functions_g[MAX_TF_FUNCTIONS][MAX_TIMER_NAME_SIZE];
+static uint32_t num_tf_functions_g = 0;
+// size of the servers' data directory before the object was created
+static uint64_t data_dir_base_g = 0;
+
+/**
+ * Region transfers of the current workload, oldest first. [head, started)
+ * are in flight and [started, count) are created but not started yet, batch
+ * mode starts those together. The queue grows with the number of chunks,
+ * max_inflight bounds how many of them are in flight.
+ */
+static pdcid_t *transfers_g = NULL;
+static uint64_t transfers_size_g = 0;
+static uint64_t transfers_head_g = 0;
+static uint64_t transfers_started_g = 0;
+static uint64_t transfers_count_g = 0;
+
+/**
+ * With pdc.reuse_transfers each chunk's transfer is created the first time
+ * the chunk is written or read and restarted on later iterations, it is only
+ * closed with the object. Its buffer must not change in between.
+ */
+static bool reuse_g = false;
+static pdcid_t *reuse_transfers_g = NULL;
+static double **reuse_buffers_g = NULL;
 
 #define OBJ_NAME "obj"
+#define CHECKSUM_TAG_NAME "chunk_checksums"
+#define STORED_BYTES_TAG_NAME "stored_bytes"
+// where the servers keep object data, see pdc_io_get_storage_size
+#define DATA_LOC_ENV "PDC_DATA_LOC"
 #define CONT_NAME "cont"
 #define PDC_NAME "pdc"
 
@@ -33,12 +68,223 @@ void pdc_io_init(config_t *config, config_workload_t *config_workload) {
 void pdc_io_deinit(config_t *config, config_workload_t *config_workload) {
     PDC_NEG_ASSERT(PDCcont_close(cont_g));
     PDC_NEG_ASSERT(PDCclose(pdc_g));
+    free(transfers_g);
+    transfers_g = NULL;
+    transfers_size_g = 0;
+}
+
+/**
+ * Remembers the function names of the workload's transform graph.
+ */
+static void pdc_io_load_tf_functions(config_workload_t *config_workload) {
+    const char *path = config_workload->pdc.tf_graph;
+    struct json_object *graph = json_object_from_file(path);
+    ASSERT(graph, "Failed to parse %s\n", path);
+
+    struct json_object *functions;
+    ASSERT(json_object_object_get_ex(graph, "functions", &functions),
+           "Transform graph %s has no functions\n", path);
+    num_tf_functions_g = 0;
+    for (size_t i = 0; i < json_object_array_length(functions); i++) {
+        struct json_object *name;
+        if (!json_object_object_get_ex(json_object_array_get_idx(functions, i),
+                                       "name", &name))
+            continue;
+        ASSERT(num_tf_functions_g < MAX_TF_FUNCTIONS,
+               CONFIG_ERROR_PREFIX
+               "Transform graph %s has more than %d named functions\n",
+               path, MAX_TF_FUNCTIONS);
+        // each function is timed as TF_TIMER_PREFIX<name>
+        const char *function = json_object_get_string(name);
+        ASSERT(strlen(function) < MAX_TIMER_NAME_SIZE - strlen(TF_TIMER_PREFIX),
+               CONFIG_ERROR_PREFIX
+               "Transform function name %s in %s is too long\n",
+               function, path);
+        strcpy(tf_functions_g[num_tf_functions_g++], function);
+    }
+    json_object_put(graph);
+}
+
+typedef struct pdc_io_tf_sample_t {
+    uint32_t function;
+    double seconds;
+} pdc_io_tf_sample_t;
+
+// total time and calls of one server timer on every server
+typedef struct pdc_io_server_timer_t {
+    char name[MAX_TIMER_NAME_SIZE];
+    // indexed by the n of PDC_SERVER[n]
+    double *totals;
+    uint64_t *counts;
+    int num_servers;
+} pdc_io_server_timer_t;
+
+// everything read from the server log at the end of a workload
+typedef struct pdc_io_server_times_t {
+    pdc_io_tf_sample_t *samples;
+    uint64_t num_samples;
+    uint64_t samples_size;
+    pdc_io_server_timer_t *timers;
+    uint32_t num_timers;
+    uint32_t timers_size;
+} pdc_io_server_times_t;
+
+static void pdc_io_add_tf_sample(pdc_io_server_times_t *times,
+                                 const char *name, double seconds) {
+    for (uint32_t i = 0; i < num_tf_functions_g; i++) {
+        if (strcmp(name, tf_functions_g[i])) continue;
+
+        if (times->num_samples == times->samples_size) {
+            times->samples_size =
+                times->samples_size ? 2 * times->samples_size : 64;
+            times->samples = (pdc_io_tf_sample_t *) realloc(
+                times->samples,
+                times->samples_size * sizeof(pdc_io_tf_sample_t));
+            ASSERT(times->samples, "Failed to grow the transform samples\n");
+        }
+        times->samples[times->num_samples++] =
+            (pdc_io_tf_sample_t){i, seconds};
+        return;
+    }
+}
+
+static void pdc_io_add_server_time(pdc_io_server_times_t *times, int server,
+                                   const char *name, double seconds) {
+    uint32_t i = 0;
+    while (i < times->num_timers && strcmp(times->timers[i].name, name)) i++;
+    if (i == times->num_timers && i == times->timers_size) {
+        times->timers_size = times->timers_size ? 2 * times->timers_size : 16;
+        times->timers = (pdc_io_server_timer_t *) realloc(
+            times->timers, times->timers_size * sizeof(pdc_io_server_timer_t));
+        ASSERT(times->timers, "Failed to grow the server timers\n");
+    }
+    pdc_io_server_timer_t *timer = &times->timers[i];
+    if (i == times->num_timers) {
+        memset(timer, 0, sizeof(*timer));
+        snprintf(timer->name, sizeof(timer->name), "%s", name);
+        times->num_timers++;
+    }
+
+    if (server >= timer->num_servers) {
+        int num_servers = server + 1;
+        timer->totals = (double *) realloc(timer->totals,
+                                           num_servers * sizeof(double));
+        timer->counts = (uint64_t *) realloc(timer->counts,
+                                             num_servers * sizeof(uint64_t));
+        ASSERT(timer->totals && timer->counts,
+               "Failed to grow the server timers to %d servers\n",
+               num_servers);
+        for (int s = timer->num_servers; s < num_servers; s++) {
+            timer->totals[s] = 0.0;
+            timer->counts[s] = 0;
+        }
+        timer->num_servers = num_servers;
+    }
+    timer->totals[server] += seconds;
+    timer->counts[server]++;
+}
+
+static void pdc_io_collect_server_time(int server, const char *name,
+                                       double seconds, void *arg) {
+    pdc_io_server_times_t *times = (pdc_io_server_times_t *) arg;
+    pdc_io_add_tf_sample(times, name, seconds);
+    // untagged lines come from a single server
+    pdc_io_add_server_time(times, server < 0 ? 0 : server, name, seconds);
+}
+
+/**
+ * Formats every server timer as "name=min/avg/max" over the servers that
+ * logged it, each server contributing its total seconds in the workload.
+ */
+static void pdc_io_format_server_times(config_t *config,
+                                       pdc_io_server_times_t *times) {
+    char *buf = config->server_timers;
+    size_t len = 0;
+    buf[0] = '\0';
+    for (uint32_t i = 0; i < times->num_timers; i++) {
+        pdc_io_server_timer_t *timer = &times->timers[i];
+        double min = 0.0, max = 0.0, sum = 0.0;
+        int num_servers = 0;
+        for (int s = 0; s < timer->num_servers; s++) {
+            if (!timer->counts[s]) continue;
+            double total = timer->totals[s];
+            if (!num_servers || total < min) min = total;
+            if (!num_servers || total > max) max = total;
+            sum += total;
+            num_servers++;
+        }
+
+        if (len < MAX_CONFIG_SERVER_TIMERS_SIZE)
+            len += snprintf(&buf[len], MAX_CONFIG_SERVER_TIMERS_SIZE - len,
+                            "%s%s=%f/%f/%f", len ? ";" : "", timer->name,
+                            min, sum / num_servers, max);
+        free(timer->totals);
+        free(timer->counts);
+    }
+}
+
+/**
+ * Reads what the servers logged during the workload. Every server timer goes
+ * into config->server_timers, which only rank 0 prints. The functions of the
+ * transform graph are also reported as pdc.tf.<function> timers: every rank
+ * records the samples rank 0 read, so the cross-rank reduction is the server
+ * time. Regions a server still caches are not stored or transformed yet and
+ * are missing.
+ */
+static void pdc_io_record_server_times(config_t *config) {
+    pdc_io_server_times_t times;
+    memset(&times, 0, sizeof(times));
+    if (config->my_rank == 0 &&
+        pdc_server_log_read(pdc_io_collect_server_time, &times))
+        pdc_io_format_server_times(config, &times);
+    free(times.timers);
+
+    MPI_Bcast(&times.num_samples, 1, MPI_UINT64_T, 0, config->comm);
+    if (times.num_samples == 0) return;
+    if (config->my_rank != 0)
+        times.samples = (pdc_io_tf_sample_t *) malloc(
+            times.num_samples * sizeof(pdc_io_tf_sample_t));
+    MPI_Bcast(times.samples, times.num_samples * sizeof(pdc_io_tf_sample_t),
+              MPI_BYTE, 0, config->comm);
+
+    char timer[MAX_TIMER_NAME_SIZE];
+    for (uint64_t i = 0; i < times.num_samples; i++) {
+        snprintf(timer, sizeof(timer), TF_TIMER_PREFIX "%s",
+                 tf_functions_g[times.samples[i].function]);
+        timer_record(timer, times.samples[i].seconds);
+    }
+    free(times.samples);
+}
+
+/**
+ * Marks the server log so only this workload's times are read at close.
+ */
+static void pdc_io_start_server_log(config_t *config) {
+    num_tf_functions_g = 0;
+    if (config->my_rank == 0) pdc_server_log_mark();
+}
+
+/**
+ * The *_col calls synchronize all of MPI_COMM_WORLD, which is why config
+ * validation keeps PDC workloads off subcommunicators.
+ */
+static void pdc_io_open_obj(config_t *config) {
+    obj_g = PDCobj_open_col(OBJ_NAME, cont_g);
+    PDC_ZERO_ASSERT(obj_g);
+}
+
+static pdc_region_partition_t
+pdc_io_region_partition(config_workload_t *config_workload) {
+    const char *partition = config_workload->pdc.region_partition;
+    if (!strcmp(partition, "obj_static")) return PDC_OBJ_STATIC;
+    if (!strcmp(partition, "region_static")) return PDC_REGION_STATIC;
+    if (!strcmp(partition, "region_dynamic")) return PDC_REGION_DYNAMIC;
+    return PDC_REGION_LOCAL;
 }
 
 void pdc_io_create_dataset(config_t *config,
                            config_workload_t *config_workload) {
-    uint64_t total_chunks = config->num_ranks * config->chunks_per_rank;
-
+    pdc_io_start_server_log(config);
     cont_prop_g = PDCprop_create(PDC_CONT_CREATE, pdc_g);
     PRINT_RANK0("Creating container with name %s\n", CONT_NAME);
     cont_g = PDCcont_create_col(CONT_NAME, cont_prop_g);
@@ -46,87 +292,231 @@ void pdc_io_create_dataset(config_t *config,
     PDC_ZERO_ASSERT(cont_prop_g);
     PDC_ZERO_ASSERT(cont_g);
 
-    dims[0] = total_chunks * config->elements_per_dim;
-    dims[1] = config->elements_per_dim;
-
     obj_prop_g = PDCprop_create(PDC_OBJ_CREATE, pdc_g);
     PDC_ZERO_ASSERT(obj_prop_g);
-    PDC_NEG_ASSERT(PDCprop_set_obj_dims(obj_prop_g, 2, dims));
+    PDC_NEG_ASSERT(PDCprop_set_obj_dims(obj_prop_g, config->layout.ndims,
+                                        config->layout.global_dims));
     PDC_NEG_ASSERT(PDCprop_set_obj_type(obj_prop_g, PDC_DOUBLE));
 
-    PDCprop_set_obj_transfer_region_type(obj_prop_g, PDC_REGION_LOCAL);
+    PRINT_RANK0("Using the %s region partition\n",
+                config_workload->pdc.region_partition);
+    PDC_NEG_ASSERT(PDCprop_set_obj_transfer_region_type(
+        obj_prop_g, pdc_io_region_partition(config_workload)));
 
     if (config->my_rank == 0) {
+        const char *data_dir = getenv(DATA_LOC_ENV);
+        data_dir_base_g = data_dir ? dir_size_bytes(data_dir) : 0;
+
         PRINT_RANK0("Creating object with name %s\n", OBJ_NAME);
         obj_g = PDCobj_create(cont_g, OBJ_NAME, obj_prop_g);
         PDC_ZERO_ASSERT(obj_g);
         PDC_NEG_ASSERT(PDCobj_close(obj_g));
     }
 
-    obj_g = PDCobj_open_col(OBJ_NAME, cont_g);
-    PDC_ZERO_ASSERT(obj_g);
+    START_TIMER("pdc.obj_open");
+    pdc_io_open_obj(config);
+    STOP_TIMER("pdc.obj_open");
+    reuse_g = config_workload->pdc.reuse_transfers;
 
-    if (!strcmp(config_workload->io_filter, "zfp")) {
-        PRINT_RANK0("Enabling ZFP filter");
-        dg_id_g = PDCtf_dg_json_create(TF_GRAPHS_DIR "compression.json");
-        PDCtf_attach_to_obj(dg_id_g, obj_g, "decompressed", "compressed");
+    if (config_filter_is_zfp(config_workload)) {
+        const config_pdc_t *pdc = &config_workload->pdc;
+        PRINT_RANK0("Enabling ZFP filter in %s mode\n", config->zfp.mode);
+        PRINT_RANK0("Transform graph %s from %s to %s\n", pdc->tf_graph,
+                    pdc->tf_source_state, pdc->tf_target_state);
+        pdc_io_load_tf_functions(config_workload);
+
+        dg_id_g = PDCtf_dg_json_create(pdc->tf_graph);
+        PDC_ZERO_ASSERT(dg_id_g);
+        PDC_NEG_ASSERT(PDCtf_attach_to_obj(dg_id_g, obj_g, pdc->tf_source_state,
+                                           pdc->tf_target_state));
     }
 }
 
-pdcid_t transfers[1024];
-static int num_transfers = 0;
-
-static void pdc_io_helper(config_t *config, config_workload_t *config_workload,
-                          double *buffer, pdc_access_t access_type) {
-    num_transfers = config->cur_chunk + 1;
-
-    uint64_t local_offset[2], global_offset[2], offset_length[2];
-    local_offset[0] = 0;
-    local_offset[1] = 0;
-    global_offset[0] = (uint64_t) (config->my_rank * config->chunks_per_rank +
-                                   config->cur_chunk) *
-                       config->elements_per_dim;
-    global_offset[1] = 0;
-    offset_length[0] = config->elements_per_dim;
-    offset_length[1] = config->elements_per_dim;
-
-    pdcid_t reg = PDCregion_create(2, local_offset, offset_length);
-    pdcid_t reg_global = PDCregion_create(2, global_offset, offset_length);
-
-    transfers[config->cur_chunk] =
-        PDCregion_transfer_create(buffer, access_type, obj_g, reg, reg_global);
+/**
+ * Creates the region transfer for the current chunk. The local and global
+ * regions are only needed to build the transfer and are closed here.
+ */
+static pdcid_t pdc_io_create_transfer(config_t *config, double *buffer,
+                                      pdc_access_t access_type) {
+    const config_layout_t *layout = &config->layout;
+    uint64_t local_offset[MAX_CONFIG_DIMS] = {0};
+    uint64_t global_offset[MAX_CONFIG_DIMS];
+    uint64_t offset_length[MAX_CONFIG_DIMS];
+    layout_chunk_offset(config, config->cur_chunk, global_offset);
+    memcpy(offset_length, layout->chunk_dims, sizeof(offset_length));
 
+    START_TIMER("pdc.region_create");
+    pdcid_t reg =
+        PDCregion_create(layout->ndims, local_offset, offset_length);
+    pdcid_t reg_global =
+        PDCregion_create(layout->ndims, global_offset, offset_length);
+    STOP_TIMER("pdc.region_create");
     PDC_ZERO_ASSERT(reg);
     PDC_ZERO_ASSERT(reg_global);
-    PDC_ZERO_ASSERT(transfers[config->cur_chunk]);
-
-    // Check if we are in individual or batch mode
-    if (!strcmp("batch", config_workload->params)) {
-        // On last chunk need to start writing
-        if (config->cur_chunk + 1 == config->chunks_per_rank) {
-            if (!strcmp(config->io_participation, "independent"))
-                PDC_NEG_ASSERT(
-                    PDCregion_transfer_start_all(transfers, num_transfers));
-            else {
-                PRINT_ERROR("Collective I/O not supported in PDC\n");
-                abort();
-            }
-        }
-    } else if (!strcmp("individual", config_workload->params)) {
-        if (!strcmp(config->io_participation, "independent"))
-            PDC_NEG_ASSERT(
-                PDCregion_transfer_start(transfers[config->cur_chunk]));
-        else {
-            PRINT_ERROR("Collective I/O not supported in PDC\n");
-            abort();
+
+    START_TIMER("pdc.transfer_create");
+    pdcid_t transfer =
+        PDCregion_transfer_create(buffer, access_type, obj_g, reg, reg_global);
+    STOP_TIMER("pdc.transfer_create");
+    PDC_ZERO_ASSERT(transfer);
+
+    START_TIMER("pdc.region_close");
+    PDC_NEG_ASSERT(PDCregion_close(reg));
+    PDC_NEG_ASSERT(PDCregion_close(reg_global));
+    STOP_TIMER("pdc.region_close");
+
+    return transfer;
+}
+
+/**
+ * The current chunk's transfer, a new one or the one kept from an earlier
+ * iteration. Setup of kept transfers is timed as pdc.setup.
+ */
+static pdcid_t pdc_io_get_transfer(config_t *config, double *buffer,
+                                   pdc_access_t access_type) {
+    if (!reuse_g) return pdc_io_create_transfer(config, buffer, access_type);
+
+    uint64_t chunk = config->cur_chunk;
+    if (!reuse_transfers_g) {
+        reuse_transfers_g =
+            (pdcid_t *) calloc(config->chunks_per_rank, sizeof(pdcid_t));
+        reuse_buffers_g =
+            (double **) calloc(config->chunks_per_rank, sizeof(double *));
+    }
+    if (!reuse_transfers_g[chunk]) {
+        START_TIMER("pdc.setup");
+        reuse_transfers_g[chunk] =
+            pdc_io_create_transfer(config, buffer, access_type);
+        STOP_TIMER("pdc.setup");
+        reuse_buffers_g[chunk] = buffer;
+    }
+    ASSERT(reuse_buffers_g[chunk] == buffer,
+           "Chunk %lu changed buffers between iterations\n", chunk);
+    return reuse_transfers_g[chunk];
+}
+
+static void pdc_io_close_reused_transfers(config_t *config) {
+    if (!reuse_transfers_g) return;
+
+    START_TIMER("pdc.transfer_close");
+    for (uint64_t i = 0; i < config->chunks_per_rank; i++)
+        if (reuse_transfers_g[i])
+            PDC_NEG_ASSERT(PDCregion_transfer_close(reuse_transfers_g[i]));
+    STOP_TIMER("pdc.transfer_close");
+    free(reuse_transfers_g);
+    free(reuse_buffers_g);
+    reuse_transfers_g = NULL;
+    reuse_buffers_g = NULL;
+}
+
+static void pdc_io_push_transfer(pdcid_t transfer) {
+    if (transfers_count_g == transfers_size_g) {
+        // move the live transfers to the front before growing the queue
+        uint64_t live = transfers_count_g - transfers_head_g;
+        if (transfers_head_g)
+            memmove(transfers_g, &transfers_g[transfers_head_g],
+                    live * sizeof(pdcid_t));
+        transfers_started_g -= transfers_head_g;
+        transfers_count_g = live;
+        transfers_head_g = 0;
+
+        if (live == transfers_size_g) {
+            transfers_size_g = transfers_size_g ? 2 * transfers_size_g : 64;
+            transfers_g = (pdcid_t *) realloc(
+                transfers_g, transfers_size_g * sizeof(pdcid_t));
+            ASSERT(transfers_g, "Failed to grow the transfer queue to %lu\n",
+                   transfers_size_g);
         }
+    }
+    transfers_g[transfers_count_g++] = transfer;
+}
+
+/**
+ * Starts every created transfer, in batch mode with a single call.
+ */
+static void pdc_io_start_transfers(bool batch) {
+    uint64_t num = transfers_count_g - transfers_started_g;
+    if (num == 0) return;
+
+    pdcid_t *first = &transfers_g[transfers_started_g];
+    if (batch) {
+        START_TIMER("pdc.start_all");
+        PDC_NEG_ASSERT(PDCregion_transfer_start_all(first, num));
+        STOP_TIMER("pdc.start_all");
     } else {
+        START_TIMER("pdc.transfer_start");
+        for (uint64_t i = 0; i < num; i++)
+            PDC_NEG_ASSERT(PDCregion_transfer_start(first[i]));
+        STOP_TIMER("pdc.transfer_start");
+    }
+    transfers_started_g = transfers_count_g;
+}
+
+/**
+ * Waits on and closes the num oldest transfers in flight, in batch mode
+ * with a single wait.
+ */
+static void pdc_io_retire_transfers(uint64_t num, bool batch) {
+    ASSERT(num <= transfers_started_g - transfers_head_g,
+           "Retiring %lu transfers with %lu in flight\n", num,
+           transfers_started_g - transfers_head_g);
+    if (num == 0) return;
+
+    pdcid_t *oldest = &transfers_g[transfers_head_g];
+    if (batch) {
+        START_TIMER("pdc.wait_all");
+        PDC_NEG_ASSERT(PDCregion_transfer_wait_all(oldest, num));
+        STOP_TIMER("pdc.wait_all");
+    } else {
+        START_TIMER("pdc.wait");
+        for (uint64_t i = 0; i < num; i++)
+            PDC_NEG_ASSERT(PDCregion_transfer_wait(oldest[i]));
+        STOP_TIMER("pdc.wait");
+    }
+
+    // kept transfers are closed with the object
+    if (!reuse_g) {
+        START_TIMER("pdc.transfer_close");
+        for (uint64_t i = 0; i < num; i++)
+            PDC_NEG_ASSERT(PDCregion_transfer_close(oldest[i]));
+        STOP_TIMER("pdc.transfer_close");
+    }
+
+    transfers_head_g += num;
+    if (transfers_head_g == transfers_count_g)
+        transfers_head_g = transfers_started_g = transfers_count_g = 0;
+}
+
+/**
+ * Batch mode starts max_inflight chunks at a time, or all of them on the
+ * last chunk, after retiring the previous batch. Individual mode starts each
+ * chunk right away and retires the oldest once max_inflight are in flight.
+ */
+static void pdc_io_helper(config_t *config, config_workload_t *config_workload,
+                          double *buffer, pdc_access_t access_type) {
+    if (strcmp(config->io_participation, "independent")) {
+        PRINT_ERROR("Collective I/O not supported in PDC\n");
+        abort();
+    }
+    bool batch = !strcmp("batch", config_workload->params);
+    if (!batch && strcmp("individual", config_workload->params)) {
         PRINT_ERROR("Invalid config_workload->params");
         abort();
     }
 
-    PDC_NEG_ASSERT(PDCregion_close(reg));
-    PDC_NEG_ASSERT(PDCregion_close(reg_global));
+    uint64_t max_inflight = config_workload->pdc.max_inflight;
+    pdc_io_push_transfer(pdc_io_get_transfer(config, buffer, access_type));
+    uint64_t inflight = transfers_started_g - transfers_head_g;
+
+    if (batch) {
+        bool last = config->cur_chunk + 1 == config->chunks_per_rank;
+        uint64_t created = transfers_count_g - transfers_started_g;
+        if (!last && (!max_inflight || created < max_inflight)) return;
+        if (max_inflight) pdc_io_retire_transfers(inflight, true);
+    } else if (max_inflight && inflight == max_inflight) {
+        pdc_io_retire_transfers(1, false);
+    }
+    pdc_io_start_transfers(batch);
 }
 
 void pdc_io_write_chunk(config_t *config, config_workload_t *config_workload,
@@ -140,29 +530,141 @@ void pdc_io_read_chunk(config_t *config, config_workload_t *config_workload,
 }
 
 void pdc_io_flush(config_t *config, config_workload_t *config_workload) {
-    // No explicit flush API in PDC
-    if (!strcmp("batch", config_workload->params)) {
-        PDC_NEG_ASSERT(PDCregion_transfer_wait_all(transfers, num_transfers));
-    } else if (!strcmp("individual", config_workload->params)) {
-        for (int i = 0; i < num_transfers; i++)
-            PDC_NEG_ASSERT(PDCregion_transfer_wait(transfers[i]));
-    } else {
-        PRINT_ERROR("Invalid params_g");
+    // No explicit flush API in PDC, pipelined mode retires its own transfers
+    pdc_io_retire_transfers(transfers_started_g - transfers_head_g,
+                            !strcmp("batch", config_workload->params));
+}
+
+/**
+ * Pipelined mode starts each transfer as soon as it is created and retires
+ * them oldest first, so only pipeline_depth transfers are ever alive.
+ */
+static void pdc_io_submit_helper(config_t *config, double *buffer,
+                                 pdc_access_t access_type) {
+    if (strcmp(config->io_participation, "independent")) {
+        PRINT_ERROR("Collective I/O not supported in PDC\n");
         abort();
     }
+    pdc_io_push_transfer(pdc_io_create_transfer(config, buffer, access_type));
+    pdc_io_start_transfers(false);
+}
+
+void pdc_io_submit_write_chunk(config_t *config,
+                               config_workload_t *config_workload,
+                               double *buffer) {
+    pdc_io_submit_helper(config, buffer, PDC_WRITE);
+}
+
+void pdc_io_submit_read_chunk(config_t *config,
+                              config_workload_t *config_workload,
+                              double *buffer) {
+    pdc_io_submit_helper(config, buffer, PDC_READ);
+}
 
-    for (int i = 0; i < num_transfers; i++)
-        PDC_NEG_ASSERT(PDCregion_transfer_close(transfers[i]));
+void pdc_io_complete_chunk(config_t *config,
+                           config_workload_t *config_workload) {
+    ASSERT(transfers_started_g > transfers_head_g,
+           "complete_chunk called with nothing in flight\n");
+    pdc_io_retire_transfers(1, false);
+}
+
+/**
+ * Checksums of all chunks are gathered on rank 0 and stored as a single tag
+ * on the object, ordered by global chunk index.
+ */
+void pdc_io_store_checksums(config_t *config,
+                            config_workload_t *config_workload,
+                            uint64_t *checksums) {
+    uint64_t total_chunks = config->num_ranks * config->chunks_per_rank;
+    uint64_t *all = NULL;
+    if (config->my_rank == 0)
+        all = (uint64_t *) malloc(total_chunks * sizeof(uint64_t));
+
+    MPI_Gather(checksums, config->chunks_per_rank, MPI_UINT64_T, all,
+               config->chunks_per_rank, MPI_UINT64_T, 0, config->comm);
+
+    if (config->my_rank == 0) {
+        PDC_NEG_ASSERT(PDCobj_put_tag(obj_g, CHECKSUM_TAG_NAME, all,
+                                      PDC_UINT64,
+                                      total_chunks * sizeof(uint64_t)));
+        free(all);
+    }
+}
+
+void pdc_io_load_checksums(config_t *config,
+                           config_workload_t *config_workload,
+                           uint64_t *checksums) {
+    uint64_t total_chunks = config->num_ranks * config->chunks_per_rank;
+    void *all = NULL;
+
+    if (config->my_rank == 0) {
+        pdc_var_type_t type;
+        psize_t size;
+        PDC_NEG_ASSERT(
+            PDCobj_get_tag(obj_g, CHECKSUM_TAG_NAME, &all, &type, &size));
+        ASSERT(size == total_chunks * sizeof(uint64_t),
+               "Tag %s holds %lu bytes, expected %lu\n", CHECKSUM_TAG_NAME,
+               (uint64_t) size, total_chunks * sizeof(uint64_t));
+    }
+
+    MPI_Scatter(all, config->chunks_per_rank, MPI_UINT64_T, checksums,
+                config->chunks_per_rank, MPI_UINT64_T, 0, config->comm);
+    free(all);
+}
+
+/**
+ * PDC has no client query for the size of an object, so on write rank 0
+ * measures how much the servers' data directory ($PDC_DATA_LOC, which must be
+ * visible to the clients) grew since create_dataset and stores the result as
+ * a tag for later read workloads. Servers that still hold regions in their
+ * cache have not written them yet, so the size can be an underestimate.
+ */
+uint64_t pdc_io_get_storage_size(config_t *config,
+                                 config_workload_t *config_workload) {
+    uint64_t stored_bytes = 0;
+
+    if (config->my_rank == 0 && !strcmp(config_workload->io_type, "write")) {
+        const char *data_dir = getenv(DATA_LOC_ENV);
+        if (data_dir) {
+            uint64_t size = dir_size_bytes(data_dir);
+            stored_bytes = size > data_dir_base_g ? size - data_dir_base_g : 0;
+            PDC_NEG_ASSERT(PDCobj_put_tag(obj_g, STORED_BYTES_TAG_NAME,
+                                          &stored_bytes, PDC_UINT64,
+                                          sizeof(uint64_t)));
+        } else {
+            PRINT_ERROR("%s is not set, stored size is unknown\n",
+                        DATA_LOC_ENV);
+        }
+    } else if (config->my_rank == 0) {
+        void *value = NULL;
+        pdc_var_type_t type;
+        psize_t size;
+        if (PDCobj_get_tag(obj_g, STORED_BYTES_TAG_NAME, &value, &type,
+                           &size) >= 0 &&
+            size == sizeof(uint64_t))
+            stored_bytes = *(uint64_t *) value;
+        free(value);
+    }
+
+    MPI_Bcast(&stored_bytes, 1, MPI_UINT64_T, 0, config->comm);
+    return stored_bytes;
 }
 
 void pdc_io_close_dataset(config_t *config,
                           config_workload_t *config_workload) {
+    pdc_io_close_reused_transfers(config);
     PDC_NEG_ASSERT(PDCobj_close(obj_g));
+    pdc_io_record_server_times(config);
 }
 
 void pdc_io_open_dataset(config_t *config, config_workload_t *config_workload) {
+    pdc_io_start_server_log(config);
     cont_g = PDCcont_open_col(CONT_NAME, pdc_g);
     PDC_ZERO_ASSERT(cont_g);
-    obj_g = PDCobj_open_col(OBJ_NAME, cont_g);
-    PDC_ZERO_ASSERT(obj_g);
+    pdc_io_open_obj(config);
+    reuse_g = config_workload->pdc.reuse_transfers;
+
+    // the servers decode with the graph attached at create
+    if (config_filter_is_zfp(config_workload))
+        pdc_io_load_tf_functions(config_workload);
 }
@@ -34,5 +34,21 @@ void pdc_io_write_chunk(config_t *config, config_workload_t *config_workload,
 void pdc_io_read_chunk(config_t *config, config_workload_t *config_workload,
                        double *buffer);
 void pdc_io_flush(config_t *config, config_workload_t *config_workload);
+void pdc_io_submit_write_chunk(config_t *config,
+                               config_workload_t *config_workload,
+                               double *buffer);
+void pdc_io_submit_read_chunk(config_t *config,
+                              config_workload_t *config_workload,
+                              double *buffer);
+void pdc_io_complete_chunk(config_t *config,
+                           config_workload_t *config_workload);
+void pdc_io_store_checksums(config_t *config,
+                            config_workload_t *config_workload,
+                            uint64_t *checksums);
+void pdc_io_load_checksums(config_t *config,
+                           config_workload_t *config_workload,
+                           uint64_t *checksums);
+uint64_t pdc_io_get_storage_size(config_t *config,
+                                 config_workload_t *config_workload);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdc_server_log.h"
+#include "../common/log.h"
+#include "../common/timer.h"
+
+#define SERVER_LOG_ENV "PDC_SERVER_LOG"
+
+// offset of the first unread line, -1 without a log
+static long offset_g = -1;
+
+static FILE *pdc_server_log_open(void) {
+    const char *path = getenv(SERVER_LOG_ENV);
+    if (!path) {
+        PRINT_RANK0("Warning: %s is not set, server timers are skipped\n",
+                    SERVER_LOG_ENV);
+        return NULL;
+    }
+
+    FILE *log = fopen(path, "r");
+    if (!log) PRINT_ERROR("Failed to open server log %s\n", path);
+    return log;
+}
+
+void pdc_server_log_mark(void) {
+    offset_g = -1;
+    FILE *log = pdc_server_log_open();
+    if (!log) return;
+
+    fseek(log, 0, SEEK_END);
+    offset_g = ftell(log);
+    fclose(log);
+}
+
+bool pdc_server_log_read(pdc_server_log_timer_fn fn, void *arg) {
+    if (offset_g < 0) return false;
+    FILE *log = pdc_server_log_open();
+    if (!log) return false;
+    fseek(log, offset_g, SEEK_SET);
+
+    char *line = NULL;
+    size_t line_size = 0;
+    ssize_t len;
+    while ((len = getline(&line, &line_size, log)) > 0) {
+        // a line the server is still writing is read again next time
+        if (line[len - 1] != '\n') break;
+        offset_g += len;
+
+        const char *timer = strstr(line, "[TIMER] ");
+        if (!timer) continue;
+        int server = -1;
+        const char *tag = strstr(line, "PDC_SERVER[");
+        if (tag) sscanf(tag, "PDC_SERVER[%d]", &server);
+
+        // the width matches MAX_TIMER_NAME_SIZE
+        char name[MAX_TIMER_NAME_SIZE];
+        double seconds;
+        if (sscanf(timer, "[TIMER] %127s time_elapsed: %lf", name,
+                   &seconds) == 2)
+            fn(server, name, seconds, arg);
+    }
+    free(line);
+    fclose(log);
+    return true;
+}
@@ -0,0 +1,27 @@
+#ifndef PDC_SERVER_LOG_H
+#define PDC_SERVER_LOG_H
+
+#include <stdbool.h>
+
+/**
+ * Reads the "[TIMER] <name> time_elapsed: <seconds> s" lines the PDC servers
+ * print, so server side times can sit next to the client's timers. The
+ * servers' combined output is named by $PDC_SERVER_LOG and must be readable
+ * by rank 0, the only rank that calls these. The servers must write it line
+ * buffered (run.sh starts them under stdbuf -oL), otherwise their timer
+ * lines only reach the file when the buffer fills and get attributed to a
+ * later workload.
+ */
+typedef void (*pdc_server_log_timer_fn)(int server, const char *name,
+                                        double seconds, void *arg);
+
+// Remembers where the log ends now, the next read starts there
+void pdc_server_log_mark(void);
+/**
+ * Calls fn for every timer line logged since the mark, server is the n of
+ * PDC_SERVER[n] or -1. Moves the mark past the lines read. Returns false if
+ * there is no log to read.
+ */
+bool pdc_server_log_read(pdc_server_log_timer_fn fn, void *arg);
+
+#endif